@@ -0,0 +1,311 @@
+/*
+  burden: all burden statistics and their permutation p-values for regions of
+  a cohort, without R.
+
+  The genotypes (and, unless -p is given, the phenotype labels) are read from
+  a packed replicate file, as written by write_packed_replicate in R.  Each
+  region is a range of markers, and is tested as allBurdenStats.p.perm would
+  test it, using reproducible permutation streams: a region uses the streams
+  of the replicate numbered by a hash of its name and range of markers (see
+  power_study.hpp), so its results do not depend on the number of threads,
+  nor on the other regions or their order in the file.
+ */
+#include <power_study.hpp>
+#include <packed_replicate.hpp>
+#include <content_hash.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace {
+  const char * STAT_NAMES[POWER_NSTATS] = { "esm", "calpha", "MB.general", "MB.recessive", "MB.dominant", "LL.collapse" };
+
+  struct region
+  {
+    string name;
+    //markers first through last, counting from 1
+    unsigned first,last;
+  };
+
+  struct region_result
+  {
+    bool ok;
+    string error;
+    vector<double> observed,p;
+  };
+
+  void usage()
+  {
+    cerr << "usage: burden [options] genotypes.brdn\n"
+	 << "  -p FILE  phenotype labels (0 = control, 1 = case), one per individual, replacing those in the genotype file\n"
+	 << "  -r FILE  regions, one per line: name, first marker, last marker (counting from 1).  Default: all markers.\n"
+	 << "  -K N     number of markers used for ESM_K (default 50)\n"
+	 << "  -f       ESM_K uses Fisher's exact test of each marker, rather than the chi-squared test\n"
+	 << "  -m MAF   Li-Leal MAF cutoff (default 0.05)\n"
+	 << "  -a       Li-Leal MAF from all individuals, rather than from controls\n"
+	 << "  -z       normalize c-alpha\n"
+	 << "  -c       c-alpha counts carriers rather than copies of the minor allele\n"
+	 << "  -n N     number of permutations (default 0, meaning no p-values)\n"
+	 << "  -s SEED  random number seed (default 0)\n"
+	 << "  -t N     number of threads (default 1)\n"
+	 << "  -o FILE  output file (default: standard output)\n"
+	 << "  -b       binary output, rather than tab-separated text\n";
+  }
+
+  void fail( const string & msg )
+  {
+    cerr << "burden: " << msg << '\n';
+    exit(1);
+  }
+
+  unsigned to_unsigned( const char * s, const char opt )
+  {
+    char * end;
+    const unsigned long x = strtoul(s,&end,10);
+    if( *s == '\0' || *end != '\0' || x > numeric_limits<unsigned>::max() )
+      {
+	fail( string("invalid value for -") + opt + ": " + s );
+      }
+    return unsigned(x);
+  }
+
+  void read_phenotypes( const string & file, const unsigned & n, vector<int> & status )
+  {
+    ifstream in(file.c_str());
+    if( !in ) fail("could not open " + file);
+    status.clear();
+    int x;
+    while( in >> x ) status.push_back(x);
+    if( !in.eof() ) fail(file + " contains something other than integer labels");
+    if( status.size() != n )
+      {
+	fail(file + " does not contain one label per individual");
+      }
+  }
+
+  void read_regions( const string & file, const unsigned & ncol, vector<region> & regions )
+  {
+    ifstream in(file.c_str());
+    if( !in ) fail("could not open " + file);
+    string line;
+    for( unsigned lineno = 1 ; getline(in,line) ; ++lineno )
+      {
+	if( line.empty() || line[0] == '#' ) continue;
+	istringstream ls(line);
+	region r;
+	if( !(ls >> r.name >> r.first >> r.last) || r.first < 1 || r.first > r.last || r.last > ncol )
+	  {
+	    ostringstream o;
+	    o << file << ", line " << lineno << ": expected a name and a range of markers between 1 and " << ncol;
+	    fail(o.str());
+	  }
+	regions.push_back(r);
+      }
+  }
+
+  //The replicate whose permutation streams the region uses: 32 bits of a hash of its name and markers
+  uint64_t region_stream( const region & reg )
+  {
+    content_hash h;
+    h.add(reg.name);
+    h.add(uint64_t(reg.first));
+    h.add(uint64_t(reg.last));
+    return strtoull(h.hex().substr(0,8).c_str(),0,16);
+  }
+
+  //NaN is written as NA, which R reads as missing
+  void put_value( ostream & o, const double & x )
+  {
+    if( x != x ) o << "NA";
+    else o << x;
+  }
+
+  void put_u32( ostream & o, const uint32_t & x )
+  {
+    char b[4] = { char(x & 0xFF), char((x>>8) & 0xFF), char((x>>16) & 0xFF), char((x>>24) & 0xFF) };
+    o.write(b,4);
+  }
+
+  void put_f64( ostream & o, const double & x )
+  {
+    uint64_t bits;
+    memcpy(&bits,&x,sizeof(double));
+    put_u32(o,uint32_t(bits & 0xFFFFFFFFULL));
+    put_u32(o,uint32_t(bits >> 32));
+  }
+
+  void write_tsv( ostream & o, const vector<region> & regions, const vector<region_result> & results, const bool & perms )
+  {
+    o.precision(numeric_limits<double>::digits10);
+    o << "region\tfirst\tlast\tnsites";
+    for( unsigned j = 0 ; j < POWER_NSTATS ; ++j ) o << '\t' << STAT_NAMES[j] << ".stat";
+    if( perms )
+      {
+	for( unsigned j = 0 ; j < POWER_NSTATS ; ++j ) o << '\t' << STAT_NAMES[j] << ".p.value";
+      }
+    o << '\n';
+    for( unsigned r = 0 ; r < regions.size() ; ++r )
+      {
+	o << regions[r].name << '\t' << regions[r].first << '\t' << regions[r].last << '\t' << regions[r].last - regions[r].first + 1;
+	for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	  {
+	    o << '\t';
+	    put_value(o,results[r].observed[j]);
+	  }
+	if( perms )
+	  {
+	    for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	      {
+		o << '\t';
+		put_value(o,results[r].p[j]);
+	      }
+	  }
+	o << '\n';
+      }
+  }
+
+  /*
+    Binary output, with unsigned 32-bit integers and IEEE doubles stored least
+    significant byte first: "BRRS", format version (1), the number of regions,
+    and the number of statistics.  Then, for each region, the length of its name,
+    the name, its first and last markers, the observed statistics, and the
+    p-values (NaN if there were no permutations), in the order of allBurdenStats.
+  */
+  void write_binary( ostream & o, const vector<region> & regions, const vector<region_result> & results )
+  {
+    o.write("BRRS",4);
+    put_u32(o,1);
+    put_u32(o,regions.size());
+    put_u32(o,POWER_NSTATS);
+    for( unsigned r = 0 ; r < regions.size() ; ++r )
+      {
+	put_u32(o,regions[r].name.size());
+	o.write(regions[r].name.data(),regions[r].name.size());
+	put_u32(o,regions[r].first);
+	put_u32(o,regions[r].last);
+	for( unsigned j = 0 ; j < POWER_NSTATS ; ++j ) put_f64(o,results[r].observed[j]);
+	for( unsigned j = 0 ; j < POWER_NSTATS ; ++j ) put_f64(o,results[r].p[j]);
+      }
+  }
+}
+
+int main( int argc, char ** argv )
+{
+  power_params par;
+  par.nperms = 0;
+  par.esm_K = 50;
+  par.LLc_maf = 0.05;
+  par.LLc_maf_control = true;
+  par.normalize_calpha = false;
+  par.simplecount_calpha = false;
+  par.esm_fisher = false;
+  par.seed = 0;
+  string phenofile,regionfile,outfile;
+  unsigned nthreads = 1;
+  bool binary = false;
+
+  int c;
+  while( (c = getopt(argc,argv,"p:r:K:fm:azcn:s:t:o:bh")) != -1 )
+    {
+      switch(c)
+	{
+	case 'p': phenofile = optarg; break;
+	case 'r': regionfile = optarg; break;
+	case 'K': par.esm_K = to_unsigned(optarg,'K'); break;
+	case 'f': par.esm_fisher = true; break;
+	case 'm':
+	  {
+	    char * end;
+	    par.LLc_maf = strtod(optarg,&end);
+	    if( *end != '\0' || !(par.LLc_maf >= 0.) ) fail(string("invalid value for -m: ") + optarg);
+	    break;
+	  }
+	case 'a': par.LLc_maf_control = false; break;
+	case 'z': par.normalize_calpha = true; break;
+	case 'c': par.simplecount_calpha = true; break;
+	case 'n': par.nperms = to_unsigned(optarg,'n'); break;
+	case 's': par.seed = to_unsigned(optarg,'s'); break;
+	case 't':
+	  nthreads = to_unsigned(optarg,'t');
+	  if( nthreads < 1 ) fail("-t must be at least 1");
+	  break;
+	case 'o': outfile = optarg; break;
+	case 'b': binary = true; break;
+	case 'h': usage(); return 0;
+	default: usage(); return 1;
+	}
+    }
+  if( optind != argc - 1 )
+    {
+      usage();
+      return 1;
+    }
+
+  vector<int> status;
+  unsigned nrow,ncol;
+  string error;
+  const string genofile = argv[optind];
+  if( !packed_replicate_header(genofile,nrow,ncol,status,error) ) fail(error);
+  if( !phenofile.empty() ) read_phenotypes(phenofile,nrow,status);
+  if( nrow == 0 ) fail("there are no individuals");
+
+  vector<region> regions;
+  if( regionfile.empty() )
+    {
+      if( ncol == 0 ) fail("there are no markers");
+      region all;
+      all.name = "all";
+      all.first = 1;
+      all.last = ncol;
+      regions.push_back(all);
+    }
+  else
+    {
+      read_regions(regionfile,ncol,regions);
+    }
+
+  //Each region reads only its own block of markers, so memory use does not grow with the size of the cohort's file
+  vector<region_result> results(regions.size());
+  const int nregions = int(regions.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+#endif
+  for( int r = 0 ; r < nregions ; ++r )
+    {
+      const region & reg = regions[r];
+      const unsigned nsites = reg.last-reg.first+1;
+      vector<int> genos;
+      results[r].ok = packed_replicate_read_columns(genofile,reg.first-1,nsites,genos,results[r].error) &&
+	burden_block_test(&genos[0],nrow,nsites,&status[0],region_stream(reg),par,results[r].observed,results[r].p,results[r].error);
+    }
+  for( unsigned r = 0 ; r < results.size() ; ++r )
+    {
+      if( !results[r].ok ) fail("region " + regions[r].name + ": " + results[r].error);
+    }
+
+  ofstream fout;
+  if( !outfile.empty() )
+    {
+      fout.open(outfile.c_str(), binary ? ios::out|ios::binary|ios::trunc : ios::out|ios::trunc);
+      if( !fout ) fail("could not open " + outfile + " for writing");
+    }
+  ostream & out = outfile.empty() ? cout : fout;
+  if( binary ) write_binary(out,regions,results);
+  else write_tsv(out,regions,results,par.nperms > 0);
+  out.flush();
+  if( !out ) fail("error writing the results");
+  return 0;
+}
@@ -0,0 +1,604 @@
+/*
+  burden-server: answers burden test queries against one cohort, which is
+  loaded once and kept in memory.
+
+  The cohort is read from a packed replicate file and converted to sparse
+  (carrier) form at start-up.  Clients connect to a Unix domain socket and
+  send one request per line.  Fields are separated by spaces:
+
+  TEST id sites=SPEC [K=N] [fisher=0|1] [maf=X] [mafall=0|1] [normalize=0|1] [simple=0|1] [nperms=N] [seed=N]
+     Test the markers in SPEC, a comma-separated list of markers and ranges
+     of markers, counting from 1 (for example, 1-20,25,31-40), or "all".
+     A marker may only be listed once.
+     The other fields override the defaults given on the command line.
+     The reply, once the test is done, is
+     OK id nsites esm calpha MB.general MB.recessive MB.dominant LL.collapse p.esm ... p.LL.collapse
+     with the statistics and p-values in the order of allBurdenStats.  NaN is written as NA.
+  CANCEL id
+     Stop the query id of this connection.  Its reply is "ERR id cancelled".
+  INFO
+     Replies "INFO nindividuals nmarkers ncases".
+  PING
+     Replies "PONG".
+
+  A malformed request gets "ERR id message" (id is "-" if there is none).
+  A line longer than MAX_LINE bytes gets "ERR - request too long", and the
+  connection is closed.  Each connection is served by its own thread, and at
+  most -C connections are open at once; a client beyond that gets
+  "ERR - too many connections", and is disconnected.  A connection may have
+  at most -Q unfinished TEST queries; another one gets "ERR id too many queries".
+  Queries from all connections share one pool of worker threads, and replies
+  to TEST are sent when each query finishes, so they may arrive out of order.
+  Closing a connection cancels its unfinished queries.
+
+  Permutations use stream 0 of the seed (see power_study.hpp), so a query gives
+  the same p-values as allBurdenStatsPermShard with the same seed and number
+  of permutations.
+
+  The server will not remove an existing file at the socket path, unless it
+  is a socket that no server is listening on any more.
+ */
+#include <power_study.hpp>
+#include <packed_replicate.hpp>
+#include <sparse_genotypes.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+  //Genotypes decoded at once while loading the cohort
+  const unsigned LOAD_BLOCK_CELLS = 1u << 24;
+
+  //Longest request line accepted, in bytes.  A sites= list of a few hundred thousand markers fits.
+  const size_t MAX_LINE = 1u << 22;
+
+  //Connections being served, each by its own thread, and the most allowed (-C)
+  std::atomic<unsigned> nconnections(0);
+  unsigned max_connections = 64;
+
+  //Unfinished TEST queries allowed per connection (-Q)
+  unsigned max_queries = 16;
+
+  //The cohort, which is never modified after start-up
+  sparse_genotypes * cohort = 0;
+  vector<int> cohort_status;
+  power_params defaults;
+
+  struct query;
+
+  //A client connection.  Worker threads hold references to it until their replies are sent.
+  struct connection
+  {
+    int fd;
+    unsigned refs;
+    pthread_mutex_t lock,write_lock;
+    map<string,query *> active;
+    connection( const int & __fd );
+    ~connection();
+  };
+
+  struct query
+  {
+    connection * conn;
+    string id;
+    vector<unsigned> columns;
+    power_params par;
+    //Set by CANCEL, or when the connection closes, and polled by burden_sparse_test
+    std::atomic<int> cancel;
+  };
+
+  //The work queue shared by all worker threads
+  deque<query *> jobs;
+  pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+  pthread_cond_t jobs_ready = PTHREAD_COND_INITIALIZER;
+
+  connection::connection( const int & __fd ) : fd(__fd), refs(1), active(map<string,query *>())
+  {
+    pthread_mutex_init(&lock,0);
+    pthread_mutex_init(&write_lock,0);
+  }
+
+  connection::~connection()
+  {
+    close(fd);
+    pthread_mutex_destroy(&lock);
+    pthread_mutex_destroy(&write_lock);
+  }
+
+  void release( connection * c )
+  {
+    pthread_mutex_lock(&c->lock);
+    const unsigned refs = --c->refs;
+    pthread_mutex_unlock(&c->lock);
+    if( refs == 0 ) delete c;
+  }
+
+  //Sends one line.  Errors are ignored: a client that has gone away just misses its reply.
+  void reply( connection * c, const string & line )
+  {
+    const string msg = line + '\n';
+    pthread_mutex_lock(&c->write_lock);
+    size_t sent = 0;
+    while( sent < msg.size() )
+      {
+	const ssize_t k = send(c->fd,msg.data()+sent,msg.size()-sent,MSG_NOSIGNAL);
+	if( k < 0 && errno == EINTR ) continue;
+	if( k <= 0 ) break;
+	sent += size_t(k);
+      }
+    pthread_mutex_unlock(&c->write_lock);
+  }
+
+  void put_value( ostream & o, const double & x )
+  {
+    if( x != x ) o << "NA";
+    else o << x;
+  }
+
+  void * worker( void * )
+  {
+    for(;;)
+      {
+	pthread_mutex_lock(&jobs_lock);
+	while( jobs.empty() ) pthread_cond_wait(&jobs_ready,&jobs_lock);
+	query * q = jobs.front();
+	jobs.pop_front();
+	pthread_mutex_unlock(&jobs_lock);
+
+	vector<double> observed,p;
+	string error = "cancelled";
+	bool ok = false;
+	if( !q->cancel.load(std::memory_order_relaxed) )
+	  {
+	    sparse_genotypes G(*cohort,q->columns);
+	    ok = burden_sparse_test(G,&cohort_status[0],0,q->par,observed,p,error,&q->cancel);
+	  }
+	ostringstream o;
+	o.precision(numeric_limits<double>::digits10);
+	if( ok )
+	  {
+	    o << "OK " << q->id << ' ' << q->columns.size();
+	    for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	      {
+		o << ' ';
+		put_value(o,observed[j]);
+	      }
+	    for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	      {
+		o << ' ';
+		put_value(o,p[j]);
+	      }
+	  }
+	else
+	  {
+	    o << "ERR " << q->id << ' ' << error;
+	  }
+	reply(q->conn,o.str());
+	pthread_mutex_lock(&q->conn->lock);
+	q->conn->active.erase(q->id);
+	pthread_mutex_unlock(&q->conn->lock);
+	release(q->conn);
+	delete q;
+      }
+    return 0;
+  }
+
+  bool parse_unsigned( const string & s, unsigned & x )
+  {
+    if( s.empty() ) return false;
+    char * end;
+    errno = 0;
+    const unsigned long v = strtoul(s.c_str(),&end,10);
+    if( *end != '\0' || errno || v > numeric_limits<unsigned>::max() || s[0] == '-' ) return false;
+    x = unsigned(v);
+    return true;
+  }
+
+  bool parse_flag( const string & s, bool & x )
+  {
+    if( s != "0" && s != "1" ) return false;
+    x = (s == "1");
+    return true;
+  }
+
+  //Markers and ranges of markers, counting from 1, as 0-based column indexes.  Fails if a marker is listed more than once.
+  bool parse_sites( const string & spec, vector<unsigned> & columns )
+  {
+    const unsigned ncol = cohort->ncol;
+    //Markers listed so far, so that there are never more columns than markers
+    vector<bool> listed(ncol,false);
+    if( spec == "all" )
+      {
+	for( unsigned j = 0 ; j < ncol ; ++j ) columns.push_back(j);
+	return ncol > 0;
+      }
+    istringstream in(spec);
+    string item;
+    while( getline(in,item,',') )
+      {
+	const string::size_type dash = item.find('-');
+	unsigned a,b;
+	if( dash == string::npos )
+	  {
+	    if( !parse_unsigned(item,a) ) return false;
+	    b = a;
+	  }
+	else if( !parse_unsigned(item.substr(0,dash),a) || !parse_unsigned(item.substr(dash+1),b) )
+	  {
+	    return false;
+	  }
+	if( a < 1 || a > b || b > ncol ) return false;
+	for( unsigned j = a ; j <= b ; ++j )
+	  {
+	    if( listed[j-1] ) return false;
+	    listed[j-1] = true;
+	    columns.push_back(j-1);
+	  }
+      }
+    return !columns.empty();
+  }
+
+  //Handles one request line.  Returns false if the connection should be closed.
+  bool handle( connection * c, const string & line )
+  {
+    istringstream in(line);
+    string cmd;
+    if( !(in >> cmd) ) return true;
+    if( cmd == "PING" )
+      {
+	reply(c,"PONG");
+      }
+    else if( cmd == "INFO" )
+      {
+	ostringstream o;
+	unsigned ncases = 0;
+	for( unsigned i = 0 ; i < cohort_status.size() ; ++i ) ncases += cohort_status[i];
+	o << "INFO " << cohort->nrow << ' ' << cohort->ncol << ' ' << ncases;
+	reply(c,o.str());
+      }
+    else if( cmd == "CANCEL" )
+      {
+	string id;
+	if( !(in >> id) )
+	  {
+	    reply(c,"ERR - CANCEL needs a query id");
+	    return true;
+	  }
+	pthread_mutex_lock(&c->lock);
+	map<string,query *>::iterator itr = c->active.find(id);
+	if( itr != c->active.end() ) itr->second->cancel.store(1);
+	const bool found = ( itr != c->active.end() );
+	pthread_mutex_unlock(&c->lock);
+	if( !found ) reply(c,"ERR " + id + " no such query");
+      }
+    else if( cmd == "TEST" )
+      {
+	query * q = new query();
+	q->conn = c;
+	q->par = defaults;
+	q->cancel.store(0);
+	if( !(in >> q->id) )
+	  {
+	    delete q;
+	    reply(c,"ERR - TEST needs a query id");
+	    return true;
+	  }
+	string field,error;
+	bool have_sites = false;
+	while( error.empty() && in >> field )
+	  {
+	    const string::size_type eq = field.find('=');
+	    const string key = field.substr(0,eq), value = (eq == string::npos) ? string() : field.substr(eq+1);
+	    bool ok;
+	    if( key == "sites" ) ok = !have_sites && (have_sites = parse_sites(value,q->columns));
+	    else if( key == "K" ) ok = parse_unsigned(value,q->par.esm_K);
+	    else if( key == "nperms" ) ok = parse_unsigned(value,q->par.nperms);
+	    else if( key == "seed" )
+	      {
+		unsigned s = 0;
+		ok = parse_unsigned(value,s);
+		q->par.seed = s;
+	      }
+	    else if( key == "maf" )
+	      {
+		char * end;
+		q->par.LLc_maf = strtod(value.c_str(),&end);
+		ok = !value.empty() && *end == '\0' && q->par.LLc_maf >= 0.;
+	      }
+	    else if( key == "mafall" )
+	      {
+		bool all = false;
+		ok = parse_flag(value,all);
+		q->par.LLc_maf_control = !all;
+	      }
+	    else if( key == "normalize" ) ok = parse_flag(value,q->par.normalize_calpha);
+	    else if( key == "simple" ) ok = parse_flag(value,q->par.simplecount_calpha);
+	    else if( key == "fisher" ) ok = parse_flag(value,q->par.esm_fisher);
+	    else ok = false;
+	    if( !ok ) error = "invalid field " + field;
+	  }
+	if( error.empty() && !have_sites ) error = "TEST needs sites=";
+	if( error.empty() )
+	  {
+	    pthread_mutex_lock(&c->lock);
+	    if( c->active.count(q->id) )
+	      {
+		error = "a query with this id is already running";
+	      }
+	    else if( c->active.size() >= max_queries )
+	      {
+		error = "too many queries";
+	      }
+	    else
+	      {
+		c->active[q->id] = q;
+		++c->refs;
+	      }
+	    pthread_mutex_unlock(&c->lock);
+	  }
+	if( !error.empty() )
+	  {
+	    reply(c,"ERR " + q->id + " " + error);
+	    delete q;
+	    return true;
+	  }
+	pthread_mutex_lock(&jobs_lock);
+	jobs.push_back(q);
+	pthread_cond_signal(&jobs_ready);
+	pthread_mutex_unlock(&jobs_lock);
+      }
+    else if( cmd == "QUIT" )
+      {
+	return false;
+      }
+    else
+      {
+	reply(c,"ERR - unknown request " + cmd);
+      }
+    return true;
+  }
+
+  void * serve( void * arg )
+  {
+    connection * c = static_cast<connection *>(arg);
+    string buffer;
+    char chunk[4096];
+    bool open = true;
+    while( open )
+      {
+	const ssize_t k = recv(c->fd,chunk,sizeof(chunk),0);
+	if( k < 0 && errno == EINTR ) continue;
+	if( k <= 0 ) break;
+	buffer.append(chunk,size_t(k));
+	string::size_type nl;
+	while( open && (nl = buffer.find('\n')) != string::npos )
+	  {
+	    string line = buffer.substr(0,nl);
+	    buffer.erase(0,nl+1);
+	    if( !line.empty() && line[line.size()-1] == '\r' ) line.erase(line.size()-1);
+	    if( line.size() > MAX_LINE )
+	      {
+		reply(c,"ERR - request too long");
+		open = false;
+	      }
+	    else
+	      {
+		open = handle(c,line);
+	      }
+	  }
+	//What is left has no newline, and so is the start of a line
+	if( open && buffer.size() > MAX_LINE )
+	  {
+	    reply(c,"ERR - request too long");
+	    open = false;
+	  }
+      }
+    //Nobody is left to read the replies of unfinished queries
+    pthread_mutex_lock(&c->lock);
+    for( map<string,query *>::iterator itr = c->active.begin() ; itr != c->active.end() ; ++itr )
+      {
+	itr->second->cancel.store(1);
+      }
+    pthread_mutex_unlock(&c->lock);
+    shutdown(c->fd,SHUT_RD);
+    release(c);
+    nconnections.fetch_sub(1);
+    return 0;
+  }
+
+  void usage()
+  {
+    cerr << "usage: burden-server -S socket [options] genotypes.brdn\n"
+	 << "  -S PATH  the Unix domain socket to listen on\n"
+	 << "  -p FILE  phenotype labels (0 = control, 1 = case), one per individual, replacing those in the genotype file\n"
+	 << "  -t N     number of worker threads (default 1)\n"
+	 << "  -C N     maximum number of client connections (default 64)\n"
+	 << "  -Q N     maximum number of unfinished queries per connection (default 16)\n"
+	 << "  default parameters of queries:\n"
+	 << "  -K N     number of markers used for ESM_K (default 50)\n"
+	 << "  -f       ESM_K uses Fisher's exact test of each marker, rather than the chi-squared test\n"
+	 << "  -m MAF   Li-Leal MAF cutoff (default 0.05)\n"
+	 << "  -a       Li-Leal MAF from all individuals, rather than from controls\n"
+	 << "  -z       normalize c-alpha\n"
+	 << "  -c       c-alpha counts carriers rather than copies of the minor allele\n"
+	 << "  -n N     number of permutations (default 0, meaning no p-values)\n"
+	 << "  -s SEED  random number seed (default 0)\n";
+  }
+
+  void fail( const string & msg )
+  {
+    cerr << "burden-server: " << msg << '\n';
+    exit(1);
+  }
+
+  /*
+    Removes a socket left at path by a server that has exited.  Fails if path is
+    anything other than a socket, or if a server is still listening on it.
+  */
+  void remove_stale_socket( const string & path, const sockaddr_un & addr )
+  {
+    struct stat st;
+    if( lstat(path.c_str(),&st) != 0 )
+      {
+	if( errno == ENOENT ) return;
+	fail("could not check " + path + ": " + strerror(errno));
+      }
+    if( !S_ISSOCK(st.st_mode) ) fail(path + " exists and is not a socket");
+    const int probe = socket(AF_UNIX,SOCK_STREAM,0);
+    const bool live = ( probe >= 0 && connect(probe,reinterpret_cast<const sockaddr *>(&addr),sizeof(addr)) == 0 );
+    if( probe >= 0 ) close(probe);
+    if( live ) fail("a server is already listening on " + path);
+    if( unlink(path.c_str()) != 0 ) fail("could not remove " + path + ": " + strerror(errno));
+  }
+
+  unsigned to_unsigned( const char * s, const char opt )
+  {
+    unsigned x;
+    if( !parse_unsigned(s,x) ) fail( string("invalid value for -") + opt + ": " + s );
+    return x;
+  }
+}
+
+int main( int argc, char ** argv )
+{
+  defaults.nperms = 0;
+  defaults.esm_K = 50;
+  defaults.LLc_maf = 0.05;
+  defaults.LLc_maf_control = true;
+  defaults.normalize_calpha = false;
+  defaults.simplecount_calpha = false;
+  defaults.esm_fisher = false;
+  defaults.seed = 0;
+  string socket_path,phenofile;
+  unsigned nthreads = 1;
+
+  int c;
+  while( (c = getopt(argc,argv,"S:p:t:C:Q:K:fm:azcn:s:h")) != -1 )
+    {
+      switch(c)
+	{
+	case 'S': socket_path = optarg; break;
+	case 'p': phenofile = optarg; break;
+	case 't': nthreads = to_unsigned(optarg,'t'); break;
+	case 'C': max_connections = to_unsigned(optarg,'C'); break;
+	case 'Q': max_queries = to_unsigned(optarg,'Q'); break;
+	case 'K': defaults.esm_K = to_unsigned(optarg,'K'); break;
+	case 'f': defaults.esm_fisher = true; break;
+	case 'm':
+	  {
+	    char * end;
+	    defaults.LLc_maf = strtod(optarg,&end);
+	    if( *end != '\0' || !(defaults.LLc_maf >= 0.) ) fail(string("invalid value for -m: ") + optarg);
+	    break;
+	  }
+	case 'a': defaults.LLc_maf_control = false; break;
+	case 'z': defaults.normalize_calpha = true; break;
+	case 'c': defaults.simplecount_calpha = true; break;
+	case 'n': defaults.nperms = to_unsigned(optarg,'n'); break;
+	case 's': defaults.seed = to_unsigned(optarg,'s'); break;
+	case 'h': usage(); return 0;
+	default: usage(); return 1;
+	}
+    }
+  if( optind != argc - 1 || socket_path.empty() || nthreads == 0 || max_connections == 0 || max_queries == 0 )
+    {
+      usage();
+      return 1;
+    }
+
+  const string genofile = argv[optind];
+  unsigned nrow,ncol;
+  string error;
+  if( !packed_replicate_header(genofile,nrow,ncol,cohort_status,error) ) fail(error);
+  if( !phenofile.empty() )
+    {
+      ifstream in(phenofile.c_str());
+      if( !in ) fail("could not open " + phenofile);
+      cohort_status.clear();
+      int x;
+      while( in >> x ) cohort_status.push_back(x);
+      if( !in.eof() || cohort_status.size() != nrow ) fail(phenofile + " does not contain one integer label per individual");
+    }
+  if( nrow == 0 ) fail("there are no individuals");
+  for( unsigned i = 0 ; i < nrow ; ++i )
+    {
+      if( cohort_status[i] != 0 && cohort_status[i] != 1 ) fail("phenotype label other than 0 or 1 encountered");
+    }
+  //The cohort is converted to sparse form a block of markers at a time, so it is never held densely
+  cohort = new sparse_genotypes(0,nrow,0);
+  const unsigned block = max(1u,LOAD_BLOCK_CELLS/nrow);
+  vector<int> genos;
+  for( unsigned first = 0 ; first < ncol ; first += block )
+    {
+      const unsigned n = min(block,ncol-first);
+      if( !packed_replicate_read_columns(genofile,first,n,genos,error) ) fail(error);
+      cohort->add_columns(&genos[0],n);
+    }
+
+  const int fd = socket(AF_UNIX,SOCK_STREAM,0);
+  sockaddr_un addr;
+  memset(&addr,0,sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if( socket_path.size() >= sizeof(addr.sun_path) ) fail("socket path is too long");
+  strcpy(addr.sun_path,socket_path.c_str());
+  remove_stale_socket(socket_path,addr);
+  if( fd < 0 || bind(fd,reinterpret_cast<sockaddr *>(&addr),sizeof(addr)) != 0 || listen(fd,64) != 0 )
+    {
+      fail("could not listen on " + socket_path + ": " + strerror(errno));
+    }
+  signal(SIGPIPE,SIG_IGN);
+
+  pthread_attr_t detached;
+  pthread_attr_init(&detached);
+  pthread_attr_setdetachstate(&detached,PTHREAD_CREATE_DETACHED);
+  for( unsigned t = 0 ; t < nthreads ; ++t )
+    {
+      pthread_t tid;
+      if( pthread_create(&tid,&detached,worker,0) != 0 ) fail("could not start worker threads");
+    }
+  cerr << "burden-server: " << nrow << " individuals, " << ncol << " markers, listening on " << socket_path << '\n';
+  for(;;)
+    {
+      const int cfd = accept(fd,0,0);
+      if( cfd < 0 )
+	{
+	  if( errno == EINTR ) continue;
+	  fail(string("accept failed: ") + strerror(errno));
+	}
+      connection * conn = new connection(cfd);
+      //Only the accepting thread adds connections, so checking, then adding, does not race
+      if( nconnections.load() >= max_connections )
+	{
+	  reply(conn,"ERR - too many connections");
+	  release(conn);
+	  continue;
+	}
+      nconnections.fetch_add(1);
+      pthread_t tid;
+      if( pthread_create(&tid,&detached,serve,conn) != 0 )
+	{
+	  nconnections.fetch_sub(1);
+	  release(conn);
+	}
+    }
+  return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef __BURDEN_H__
+#define __BURDEN_H__
+
+/*
+  The C++ interface of buRden, for packages with "LinkingTo: buRden".
+
+  Everything here is header-only, and nothing uses R objects, so the
+  statistics may be calculated in a tight C++ loop, or by worker threads,
+  without going through R.  In brief:
+
+  sparse_genotypes: the genotype container, built from a column-major
+  matrix of minor allele counts (individuals x sites), as in an R matrix.
+
+  site_patterns: the sites of a sparse_genotypes grouped by carriers, found
+  once and passed to stat_multitrait when the same sites are scored many times.
+
+  stat_multitrait: all burden statistics of allBurdenStats (ESM, c-alpha,
+  Madsen-Browning, and Li-Leal) for one or many labellings in one pass over
+  the genotypes.  Results are returned in a multitrait_values.  The kernels
+  used by it (chisq, fisher_exact, cAlpha_Z, esm_stat, and the mb_*
+  functions) are available as well.
+
+  burden_sparse_test and burden_block_test: observed statistics and
+  permutation p-values, with permutations from perm_rng, given the
+  parameters in a power_params.  The results are in the same order as
+  allBurdenStats: esm, calpha, MB.general, MB.recessive, MB.dominant,
+  and LL.collapse.
+
+  The functions use R's distribution functions, so a package that uses
+  them links to R as usual.
+ */
+
+#include "buRden/config.hpp"
+#include "buRden/burden_math.hpp"
+#include "buRden/sparse_genotypes.hpp"
+#include "buRden/site_patterns.hpp"
+#include "buRden/perm_rng.hpp"
+#include "buRden/chisq.hpp"
+#include "buRden/cAlpha_variance.hpp"
+#include "buRden/esm_stat.hpp"
+#include "buRden/fisher_exact.hpp"
+#include "buRden/mb_scores.hpp"
+#include "buRden/stat_multitrait.hpp"
+#include "buRden/power_study.hpp"
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __BURDEN_MATH_HPP__
+#define __BURDEN_MATH_HPP__
+
+/*
+  R's chi-squared distribution function, for code that does not use Rcpp.
+
+  Inside R, this is Rf_pchisq.  The standalone libRmath, used
+  when BURDEN_STANDALONE is defined (see cli/Makefile), has the plain name
+  instead.  It is declared here rather than by including Rmath.h,
+  which defines macros for many common names, so that this header may be
+  included by code that uses those names.  The declaration is the same as
+  Rmath.h's, so either header may be included first.
+ */
+#ifdef BURDEN_STANDALONE
+extern "C" {
+  double pchisq(double, double, int, int);
+}
+#else
+extern "C" {
+  double Rf_pchisq(double, double, int, int);
+}
+#endif
+
+inline double burden_pchisq( const double & x, const double & df, const int & lower_tail, const int & log_p )
+{
+#ifdef BURDEN_STANDALONE
+  return pchisq(x,df,lower_tail,log_p);
+#else
+  return Rf_pchisq(x,df,lower_tail,log_p);
+#endif
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef __CALPHA_VARIANCE_HPP__
+#define __CALPHA_VARIANCE_HPP__
+
+#include "config.hpp"
+#include <map>
+
+/*
+  Variance of the c-alpha statistic, given ns, which maps the number of
+  observations of the mutation at a site to the number of such sites, and
+  p0, the proportion of cases.
+*/
+BURDEN_DECL double cAlpha_Z( const std::map<unsigned,unsigned> & ns, const double & p0 );
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/cAlpha_variance.ipp"
+#endif
+
+#endif
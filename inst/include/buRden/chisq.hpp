@@ -0,0 +1,23 @@
+#ifndef __CHISQ_HPP__
+#define __CHISQ_HPP__
+
+#include "config.hpp"
+
+BURDEN_DECL double chisq(const unsigned & a,
+			 const unsigned & b,
+			 const unsigned & c,
+			 const unsigned & d,
+			 const bool & yates = true);
+
+/*
+  -log10 p-value of the chi-squared test of a 2x2 table of minor and
+  major allele counts in controls (a,b) and cases (c,d).
+ */
+BURDEN_DECL double chisq_log10p( const unsigned & a, const unsigned & b,
+				 const unsigned & c, const unsigned & d );
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/chisq.ipp"
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef __BURDEN_CONFIG_HPP__
+#define __BURDEN_CONFIG_HPP__
+
+/*
+  The C++ core of buRden may be used header-only, by including <buRden.h>
+  from a package with "LinkingTo: buRden", or compiled once into a library.
+
+  buRden itself and the command-line programs in cli/ define
+  BURDEN_SEPARATE_COMPILATION, so that each implementation file (impl/X.ipp) is
+  compiled once, by src/X.cc.  Otherwise, every header includes its
+  implementation, and the functions are inline.
+ */
+#ifdef BURDEN_SEPARATE_COMPILATION
+#define BURDEN_DECL
+#else
+#define BURDEN_DECL inline
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef __ESM_STAT_HPP__
+#define __ESM_STAT_HPP__
+
+#include "config.hpp"
+#include <vector>
+#include <cmath>
+
+//Same as esm, without R objects or boost::accumulators, for use from threads
+BURDEN_DECL double esm_stat( std::vector<double> scores, const unsigned & K );
+
+//ESM from the largest scores, in decreasing order, out of ntests
+template<typename iterator>
+double esm_top( iterator largest, iterator end, const unsigned & ntests )
+{
+  double rv = 0.;
+  for( unsigned i = 0 ; largest != end ; ++largest, ++i )
+    {
+      rv = rv + (*largest - (-std::log10((i+1)/double(ntests))));
+    }
+  return rv;
+}
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/esm_stat.ipp"
+#endif
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef __FISHER_EXACT_HPP__
+#define __FISHER_EXACT_HPP__
+
+#include "config.hpp"
+#include <cstddef>
+#include <map>
+#include <vector>
+
+/*
+  Fisher's exact test of a 2x2 table of minor and major allele counts in
+  controls and cases, as an alternative per-marker test to the chi-squared.
+
+  With N alleles in all, m of them in cases, and K minor alleles at a site,
+  the number of minor alleles in cases is hypergeometric.  The two-sided
+  p-value of x is the total probability of the outcomes no more likely than x,
+  with the relative tolerance of 1e-7 that R's fisher.test uses.
+
+  Probabilities are calculated from a table of log(i!) for i = 0 to N, made
+  once.  N and m are the same for every site and every permutation of the
+  labels, so the p-values of all possible x for a given K are calculated once,
+  when a site with K minor alleles is first seen, and kept.  A rare variant
+  has few possible x, so a test then costs about as much as a chi-squared.
+  At most FISHER_MAX_CELLS p-values are kept.  Once they are used up, the
+  p-value of a site with a K not already seen is calculated on its own, at a
+  cost proportional to the number of possible x.
+
+  No R objects are used.  The tables are filled as sites are seen, so an
+  instance must not be shared between threads.
+ */
+//Number of p-values that one fisher_exact keeps, in all
+const size_t FISHER_MAX_CELLS = size_t(1) << 22;
+
+class fisher_exact
+{
+private:
+  unsigned N,m;
+  size_t cells;
+  std::vector<double> logfact;
+  //-log10 p-value of each possible x, for each K seen so far
+  std::map<unsigned, std::vector<double> > tables;
+  //Probabilities of x = lo to hi, relative to the largest of them, and their total
+  void probabilities( const unsigned & K, const unsigned & lo, const unsigned & hi,
+		      std::vector<double> & d, double & total ) const;
+  const std::vector<double> & table( const unsigned & K, const unsigned & lo, const unsigned & hi );
+public:
+  //N alleles in all, m of them in cases
+  fisher_exact( const unsigned & __N, const unsigned & __m );
+  /*
+    -log10 p-value of the two-sided test of a site with K minor alleles,
+    x of them in cases.  If K > N or x is not a possible outcome, returns 0.
+  */
+  double log10p( const unsigned & K, const unsigned & x );
+};
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/fisher_exact.ipp"
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+#include "../cAlpha_variance.hpp"
+
+BURDEN_DECL double cAlpha_Z( const std::map<unsigned,unsigned> & ns, const double & p0 )
+{
+  /*
+    A site observed n times contributes E[((u-n*p0)^2 - n*p0*(1-p0))^2], where u ~ Binomial(n,p0).
+    With v = n*p0*(1-p0) the variance of u, that is mu4 - v^2, and the fourth central moment of
+    the binomial is mu4 = v*(1 + 3*(n-2)*p0*(1-p0)), so it is v*(1 + (2n-6)*p0*(1-p0)).
+  */
+  const double pq = p0*(1.-p0);
+  double Z = 0.;
+  for( std::map<unsigned,unsigned>::const_iterator itr = ns.begin() ; itr != ns.end() ; ++itr )
+    {
+      const double n = double(itr->first),m_of_n=double(itr->second);
+      Z += m_of_n*n*pq*(1. + (2.*n-6.)*pq);
+    }
+  return Z;
+}
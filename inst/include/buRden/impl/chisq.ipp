@@ -0,0 +1,33 @@
+#include "../chisq.hpp"
+#include <cmath>
+#include <algorithm>
+#include "../burden_math.hpp"
+
+BURDEN_DECL double chisq(const unsigned & a,
+			 const unsigned & b,
+			 const unsigned & c,
+			 const unsigned & d,
+			 const bool & yates)
+{
+  double _a=a,_b=b,_c=c,_d=d;
+  double __N = double(_a+_b+_c+_d);
+  double inner = std::max( 0.,std::fabs(_a*_d-_b*_c) - ( (yates) ? __N/2. : 0 ) );
+  if ( inner == 0. ) 
+    {
+      return 0.;
+    }
+  double rv = std::log10(__N)+2.*std::log10(inner) - ( std::log10(_a+_b)+std::log10(_c+_d)+std::log10(_b+_d)+std::log10(_a+_c) );
+  return std::pow(10,rv);
+}
+
+BURDEN_DECL double chisq_log10p( const unsigned & a, const unsigned & b,
+				 const unsigned & c, const unsigned & d )
+{
+  double rv = chisq(a,b,c,d);
+  if (! std::isfinite(rv) )
+    {
+      //then the chisquared is 0, the p-value is 1, and -log10(1) = 0 
+      return 0;
+    }
+  return ( -std::log10( burden_pchisq( rv, 1., 0, 0 )) );
+}
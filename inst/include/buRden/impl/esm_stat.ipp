@@ -0,0 +1,11 @@
+#include "../esm_stat.hpp"
+#include <algorithm>
+#include <functional>
+
+BURDEN_DECL double esm_stat( std::vector<double> scores, const unsigned & K )
+{
+  //The K largest scores, in decreasing order, as tail<right> returns them
+  const unsigned ntests = scores.size(), k = std::min(K,ntests);
+  std::partial_sort(scores.begin(),scores.begin()+k,scores.end(),std::greater<double>());
+  return esm_top(scores.begin(),scores.begin()+k,ntests);
+}
@@ -0,0 +1,88 @@
+#include "../fisher_exact.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace burden_detail {
+  //fisher.test's tolerance for outcomes that are as likely as the observed one
+  const double FISHER_REL_ERR = 1. + 1e-7;
+}
+
+BURDEN_DECL fisher_exact::fisher_exact( const unsigned & __N, const unsigned & __m ) : N(__N),
+										       m( std::min(__m,__N) ),
+										       cells(0),
+										       logfact(std::vector<double>(size_t(__N)+1,0.)),
+										       tables(std::map<unsigned, std::vector<double> >())
+{
+  for( unsigned i = 2 ; i <= N ; ++i )
+    {
+      logfact[i] = logfact[i-1] + std::log(double(i));
+    }
+}
+
+BURDEN_DECL void fisher_exact::probabilities( const unsigned & K, const unsigned & lo, const unsigned & hi,
+					      std::vector<double> & d, double & total ) const
+{
+  //log probabilities, less the largest of them, so that the sums below cannot underflow
+  d.resize(hi-lo+1);
+  for( unsigned x = lo ; x <= hi ; ++x )
+    {
+      d[x-lo] = logfact[K] - logfact[x] - logfact[K-x]
+	+ logfact[N-K] - logfact[m-x] - logfact[N-K-m+x];
+    }
+  const double lmax = *std::max_element(d.begin(),d.end());
+  total = 0.;
+  for( unsigned i = 0 ; i < d.size() ; ++i )
+    {
+      d[i] = std::exp(d[i] - lmax);
+      total += d[i];
+    }
+}
+
+BURDEN_DECL const std::vector<double> & fisher_exact::table( const unsigned & K, const unsigned & lo, const unsigned & hi )
+{
+  std::vector<double> d;
+  double total;
+  probabilities(K,lo,hi,d,total);
+  //p(x) is the sum of all d <= d(x)*FISHER_REL_ERR, from cumulative sums of the sorted d
+  std::vector<double> sorted(d),cumsum(d.size());
+  std::sort(sorted.begin(),sorted.end());
+  double s = 0.;
+  for( unsigned i = 0 ; i < sorted.size() ; ++i )
+    {
+      s += sorted[i];
+      cumsum[i] = s;
+    }
+  std::vector<double> & rv = tables[K];
+  rv.assign(hi+1,0.);
+  cells += rv.size();
+  for( unsigned x = lo ; x <= hi ; ++x )
+    {
+      const size_t k = size_t( std::upper_bound(sorted.begin(),sorted.end(),d[x-lo]*burden_detail::FISHER_REL_ERR) - sorted.begin() );
+      //-log10(cumsum/total), which is at least 0
+      rv[x] = std::max( 0., -std::log10( cumsum[k-1]/total ) );
+    }
+  return rv;
+}
+
+BURDEN_DECL double fisher_exact::log10p( const unsigned & K, const unsigned & x )
+{
+  if( K > N ) return 0.;
+  //x ranges from lo to hi
+  const unsigned lo = ( K > N - m ) ? K - (N - m) : 0, hi = std::min(K,m);
+  if( x < lo || x > hi ) return 0.;
+  std::map<unsigned, std::vector<double> >::const_iterator itr = tables.find(K);
+  if( itr != tables.end() ) return itr->second[x];
+  if( cells + hi + 1 <= FISHER_MAX_CELLS ) return table(K,lo,hi)[x];
+
+  //No room to keep the table, so only p(x) is calculated
+  std::vector<double> d;
+  double total;
+  probabilities(K,lo,hi,d,total);
+  const double dx = d[x-lo]*burden_detail::FISHER_REL_ERR;
+  double s = 0.;
+  for( unsigned i = 0 ; i < d.size() ; ++i )
+    {
+      if( d[i] <= dx ) s += d[i];
+    }
+  return std::max( 0., -std::log10( s/total ) );
+}
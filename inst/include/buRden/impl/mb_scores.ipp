@@ -0,0 +1,154 @@
+#include "../mb_scores.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+BURDEN_DECL double mb_weight( const unsigned & minor_count, const unsigned & ncontrols, const unsigned & n )
+{
+  double qi = double(minor_count + 1)/(2.*double(ncontrols)+2.);
+  return std::sqrt(double(n)*qi*(1.-qi));
+}
+
+BURDEN_DECL void mb_add_site( const std::vector<unsigned> & ind,
+			      const std::vector<int> & geno,
+			      const double & wi,
+			      std::vector<double> & scores,
+			      std::vector<double> & scores_rec,
+			      std::vector<double> & scores_dom )
+{
+  /*
+    Note: we divide rather than multiply by 1/wi, which
+    would not give the same bits as the original calculation.
+  */
+  for( unsigned k = 0 ; k < ind.size() ; ++k )
+    {
+      const unsigned i = ind[k];
+      scores[i] += double(geno[k])/wi;
+      scores_dom[i] += 1./wi;
+      if( geno[k] == 2 )
+	{
+	  scores_rec[i] += 1./wi;
+	}
+    }
+}
+
+BURDEN_DECL void mb_scores_block( const sparse_genotypes & G,
+				  const std::vector<int> & labels,
+				  const unsigned & B,
+				  const unsigned & ncontrols,
+				  std::vector<double> & scores,
+				  std::vector<double> & scores_rec,
+				  std::vector<double> & scores_dom )
+{
+  const unsigned n = G.nrow;
+  scores.assign(size_t(n)*B,0.);
+  scores_rec.assign(size_t(n)*B,0.);
+  scores_dom.assign(size_t(n)*B,0.);
+  std::vector<unsigned> minor_count(B);
+  std::vector<double> wi(B);
+  for( unsigned j = 0 ; j < G.ncol ; ++j )
+    {
+      //control allele counts under each labelling: G^T times the block of control indicators
+      std::fill(minor_count.begin(),minor_count.end(),0);
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  const int * l = &labels[size_t(G.rowind[k])*B];
+	  for( unsigned b = 0 ; b < B ; ++b )
+	    {
+	      if( !l[b] ) minor_count[b] += G.geno[k];
+	    }
+	}
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  wi[b] = mb_weight(minor_count[b],ncontrols,n);
+	}
+      //the site's carriers times the block of weights
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  const size_t offset = size_t(G.rowind[k])*B;
+	  const double g = double(G.geno[k]);
+	  const bool hom = (G.geno[k] == 2);
+	  for( unsigned b = 0 ; b < B ; ++b )
+	    {
+	      scores[offset+b] += g/wi[b];
+	      scores_dom[offset+b] += 1./wi[b];
+	      if( hom ) scores_rec[offset+b] += 1./wi[b];
+	    }
+	}
+    }
+}
+
+BURDEN_DECL void mb_rank_engine::clear()
+{
+  general.clear();
+  recessive.clear();
+  dominant.clear();
+  is_case.clear();
+}
+
+BURDEN_DECL void mb_rank_engine::push_back( const double & score, const double & score_rec, const double & score_dom, const bool & iscase )
+{
+  general.push_back(score);
+  recessive.push_back(score_rec);
+  dominant.push_back(score_dom);
+  is_case.push_back(iscase);
+}
+
+BURDEN_DECL double mb_rank_engine::ranksum( const std::vector<double> & carrier_scores,
+					    const unsigned & n,
+					    const unsigned & ncases )
+{
+  //A carrier may still score 0 (e.g., heterozygotes under the recessive model)
+  work.clear();
+  for( unsigned k = 0 ; k < carrier_scores.size() ; ++k )
+    {
+      if( carrier_scores[k] != 0. ) work.push_back( std::make_pair(carrier_scores[k],is_case[k]) );
+    }
+  std::sort(work.begin(),work.end());
+  const unsigned nzero = n - work.size();
+  unsigned cases_nonzero = 0, nneg = 0;
+  for( unsigned k = 0 ; k < work.size() ; ++k )
+    {
+      cases_nonzero += work[k].second;
+      nneg += (work[k].first < 0.);
+    }
+  //Each case with a score of zero has rank nneg+1
+  double stat = double(ncases-cases_nonzero)*double(nneg+1);
+  unsigned k = 0;
+  while( k < work.size() )
+    {
+      const unsigned below = k + ( (work[k].first > 0.) ? nzero : 0 );
+      //work[k] is always in its own group, so k advances even if the scores cannot be compared
+      unsigned cases_tied = work[k].second, j = k + 1;
+      for( ; j < work.size() && work[j].first == work[k].first ; ++j )
+	{
+	  cases_tied += work[j].second;
+	}
+      stat += double(cases_tied)*double(below+1);
+      k = j;
+    }
+  return stat;
+}
+
+BURDEN_DECL bool mb_rank_engine::finite() const
+{
+  for( unsigned k = 0 ; k < general.size() ; ++k )
+    {
+      if( !std::isfinite(general[k]) || !std::isfinite(recessive[k]) || !std::isfinite(dominant[k]) ) return false;
+    }
+  return true;
+}
+
+BURDEN_DECL void mb_rank_engine::operator()( const unsigned & n, const unsigned & ncases,
+					     double & stat, double & stat_rec, double & stat_dom )
+{
+  //Scores that are NaN or infinite cannot be ranked, or even sorted
+  if( !finite() )
+    {
+      stat = stat_rec = stat_dom = std::numeric_limits<double>::quiet_NaN();
+      return;
+    }
+  stat = ranksum(general,n,ncases);
+  stat_rec = ranksum(recessive,n,ncases);
+  stat_dom = ranksum(dominant,n,ncases);
+}
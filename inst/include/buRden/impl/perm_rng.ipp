@@ -0,0 +1,39 @@
+#include "../perm_rng.hpp"
+
+namespace burden_detail {
+  inline uint64_t splitmix64_mix( uint64_t z )
+  {
+    z = (z ^ (z >> 30)) * uint64_t(0xBF58476D1CE4E5B9ULL);
+    z = (z ^ (z >> 27)) * uint64_t(0x94D049BB133111EBULL);
+    return z ^ (z >> 31);
+  }
+  const uint64_t GOLDEN_GAMMA = uint64_t(0x9E3779B97F4A7C15ULL);
+}
+
+BURDEN_DECL perm_rng::perm_rng( const uint64_t & seed, const uint64_t & stream ) : state( burden_detail::splitmix64_mix( seed ^ burden_detail::splitmix64_mix(stream + burden_detail::GOLDEN_GAMMA) ) )
+{
+}
+
+BURDEN_DECL uint64_t perm_rng::next()
+{
+  state += burden_detail::GOLDEN_GAMMA;
+  return burden_detail::splitmix64_mix(state);
+}
+
+BURDEN_DECL unsigned perm_rng::operator()(const unsigned & n)
+{
+  //reject the top (2^64 mod n) values so that all residues are equally likely
+  const uint64_t limit = uint64_t(-1) - (uint64_t(-1) % uint64_t(n));
+  uint64_t x = next();
+  while( x >= limit )
+    {
+      x = next();
+    }
+  return unsigned(x % uint64_t(n));
+}
+
+BURDEN_DECL double perm_rng::uniform()
+{
+  //top 53 bits, scaled by 2^-53
+  return double(next() >> 11) * (1.0/9007199254740992.0);
+}
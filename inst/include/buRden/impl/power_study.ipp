@@ -0,0 +1,165 @@
+#include "../power_study.hpp"
+#include "../stat_multitrait.hpp"
+#include "../sparse_genotypes.hpp"
+#include "../perm_rng.hpp"
+#include <limits>
+
+namespace burden_detail {
+  //Pointers to the statistics, in allBurdenStats order
+  BURDEN_DECL void stat_columns( const multitrait_values & v, const std::vector<double> * cols[POWER_NSTATS] )
+  {
+    cols[0] = &v.esm;
+    cols[1] = &v.calpha;
+    cols[2] = &v.MBg;
+    cols[3] = &v.MBr;
+    cols[4] = &v.MBd;
+    cols[5] = &v.LLc;
+  }
+}
+
+BURDEN_DECL power_replicate::power_replicate() : genos(std::vector<int>()),nrow(0),ncol(0),status(std::vector<int>())
+{
+}
+
+BURDEN_DECL bool burden_block_test( const int * genos,
+				    const unsigned & nrow,
+				    const unsigned & ncol,
+				    const int * status,
+				    const uint64_t & r,
+				    const power_params & par,
+				    std::vector<double> & observed,
+				    std::vector<double> & p,
+				    std::string & error )
+{
+  sparse_genotypes G(genos,nrow,ncol);
+  for( std::vector<int>::const_iterator itr = G.geno.begin() ; itr != G.geno.end() ; ++itr )
+    {
+      if( *itr < 0 || *itr > 2 )
+	{
+	  error = "genotype value other than 0, 1, or 2 encountered";
+	  return false;
+	}
+    }
+  return burden_sparse_test(G,status,r,par,observed,p,error);
+}
+
+BURDEN_DECL void burden_perm_values( const sparse_genotypes & G,
+				     const int * status,
+				     const uint64_t & r,
+				     const unsigned & first,
+				     const unsigned & B,
+				     const power_params & par,
+				     multitrait_values & perm,
+				     std::vector<int> & labels,
+				     const site_patterns * patterns )
+{
+  const unsigned n = G.nrow;
+  labels.resize(size_t(n)*B);
+  for( unsigned b = 0 ; b < B ; ++b )
+    {
+      std::vector<int>::iterator col = labels.begin() + size_t(b)*n;
+      std::copy(status,status+n,col);
+      perm_rng rng(par.seed, (r << 32) + uint64_t(first+b));
+      perm_shuffle(col,col+n,rng);
+    }
+  stat_multitrait(&labels[0],n,B)(G,par.esm_K,par.LLc_maf,par.LLc_maf_control,
+				  par.normalize_calpha,par.simplecount_calpha,perm,patterns,par.esm_fisher);
+}
+
+BURDEN_DECL void burden_perm_block( const sparse_genotypes & G,
+				    const int * status,
+				    const uint64_t & r,
+				    const unsigned & first,
+				    const unsigned & B,
+				    const power_params & par,
+				    const std::vector<double> & observed,
+				    std::vector<unsigned> & nexceed,
+				    std::vector<int> & labels,
+				    const site_patterns * patterns )
+{
+  multitrait_values perm;
+  burden_perm_values(G,status,r,first,B,par,perm,labels,patterns);
+  const std::vector<double> * pcols[POWER_NSTATS];
+  burden_detail::stat_columns(perm,pcols);
+  for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+    {
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  nexceed[j] += ( (*pcols[j])[b] >= observed[j] );
+	}
+    }
+}
+
+BURDEN_DECL bool burden_sparse_test( const sparse_genotypes & G,
+				     const int * status,
+				     const uint64_t & r,
+				     const power_params & par,
+				     std::vector<double> & observed,
+				     std::vector<double> & p,
+				     std::string & error,
+				     const std::atomic<int> * cancel )
+{
+  const unsigned n = G.nrow;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      if( status[i] != 0 && status[i] != 1 )
+	{
+	  error = "phenotype label other than 0 or 1 encountered";
+	  return false;
+	}
+    }
+
+  //The carrier patterns do not depend on the labels, so they are found once
+  const site_patterns patterns(G);
+  multitrait_values obs;
+  stat_multitrait(status,n,1)(G,par.esm_K,par.LLc_maf,par.LLc_maf_control,
+			      par.normalize_calpha,par.simplecount_calpha,obs,&patterns,par.esm_fisher);
+  const std::vector<double> * ocols[POWER_NSTATS];
+  burden_detail::stat_columns(obs,ocols);
+
+  observed.resize(POWER_NSTATS);
+  for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+    {
+      observed[j] = (*ocols[j])[0];
+    }
+  std::vector<unsigned> nexceed(POWER_NSTATS,0);
+  std::vector<int> labels;
+  for( unsigned first = 0 ; first < par.nperms ; first += POWER_PERM_BLOCK )
+    {
+      //A flag with no other data to publish, so a relaxed load suffices
+      if( cancel && cancel->load(std::memory_order_relaxed) )
+	{
+	  error = "cancelled";
+	  return false;
+	}
+      burden_perm_block(G,status,r,first,std::min(POWER_PERM_BLOCK,par.nperms-first),par,observed,nexceed,labels,&patterns);
+    }
+  p.resize(POWER_NSTATS);
+  for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+    {
+      const double o = observed[j];
+      p[j] = ( o == o && par.nperms > 0 ) ? double(nexceed[j])/double(par.nperms) : std::numeric_limits<double>::quiet_NaN();
+    }
+  return true;
+}
+
+BURDEN_DECL bool power_replicate_p( const power_replicate & rep,
+				    const uint64_t & r,
+				    const power_params & par,
+				    std::vector<double> & p,
+				    std::string & error )
+{
+  const unsigned n = rep.nrow;
+  if( rep.status.size() != n || rep.genos.size() != size_t(n)*size_t(rep.ncol) )
+    {
+      error = "the number of phenotype labels does not match the number of individuals";
+      return false;
+    }
+  if( n == 0 || par.nperms == 0 )
+    {
+      error = "there are no individuals or no permutations";
+      return false;
+    }
+  std::vector<double> observed;
+  return burden_block_test(&rep.genos[0],n,rep.ncol,&rep.status[0],r,par,observed,p,error);
+}
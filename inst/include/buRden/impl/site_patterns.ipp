@@ -0,0 +1,81 @@
+#include "../site_patterns.hpp"
+#include <algorithm>
+#include <utility>
+#include <stdint.h>
+
+namespace burden_detail {
+  //FNV-1a hash of a site's carriers and genotypes
+  BURDEN_DECL uint64_t site_hash( const sparse_genotypes & G, const unsigned & j )
+  {
+    uint64_t h = 14695981039346656037ULL;
+    for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+      {
+	const uint64_t x = (uint64_t(G.rowind[k]) << 2) | uint64_t(G.geno[k] & 3);
+	for( unsigned b = 0 ; b < 64 ; b += 8 )
+	  {
+	    h ^= (x >> b) & uint64_t(0xFF);
+	    h *= 1099511628211ULL;
+	  }
+      }
+    return h;
+  }
+
+  BURDEN_DECL bool same_site( const sparse_genotypes & G, const unsigned & a, const unsigned & b )
+  {
+    const size_t na = G.colptr[a+1]-G.colptr[a];
+    if( na != G.colptr[b+1]-G.colptr[b] ) return false;
+    return std::equal(G.rowind.begin()+G.colptr[a],G.rowind.begin()+G.colptr[a+1],G.rowind.begin()+G.colptr[b]) &&
+      std::equal(G.geno.begin()+G.colptr[a],G.geno.begin()+G.colptr[a+1],G.geno.begin()+G.colptr[b]);
+  }
+}
+
+BURDEN_DECL site_patterns::site_patterns() : pattern(std::vector<unsigned>()),first(std::vector<unsigned>()),count(std::vector<unsigned>())
+{
+}
+
+BURDEN_DECL site_patterns::site_patterns( const sparse_genotypes & G ) : pattern(std::vector<unsigned>(G.ncol)),
+									 first(std::vector<unsigned>()),
+									 count(std::vector<unsigned>())
+{
+  //Sites sorted by hash, then by index, so that the first site of each run of equal hashes comes first
+  std::vector< std::pair<uint64_t,unsigned> > order(G.ncol);
+  for( unsigned j = 0 ; j < G.ncol ; ++j ) order[j] = std::make_pair(burden_detail::site_hash(G,j),j);
+  std::sort(order.begin(),order.end());
+  //rep[j] is the first site with site j's pattern
+  std::vector<unsigned> rep(G.ncol);
+  for( size_t a = 0 ; a < order.size() ; )
+    {
+      size_t b = a;
+      while( b < order.size() && order[b].first == order[a].first ) ++b;
+      //Sites in [a,b) have the same hash.  Compare each with the earlier representatives in the run.
+      std::vector<unsigned> reps;
+      for( size_t k = a ; k < b ; ++k )
+	{
+	  const unsigned j = order[k].second;
+	  unsigned r = 0;
+	  while( r < reps.size() && !burden_detail::same_site(G,reps[r],j) ) ++r;
+	  if( r == reps.size() ) reps.push_back(j);
+	  rep[j] = reps[r];
+	}
+      a = b;
+    }
+  for( unsigned j = 0 ; j < G.ncol ; ++j )
+    {
+      if( rep[j] == j )
+	{
+	  pattern[j] = first.size();
+	  first.push_back(j);
+	  count.push_back(1);
+	}
+      else
+	{
+	  pattern[j] = pattern[rep[j]];
+	  ++count[pattern[j]];
+	}
+    }
+}
+
+BURDEN_DECL unsigned site_patterns::npatterns() const
+{
+  return first.size();
+}
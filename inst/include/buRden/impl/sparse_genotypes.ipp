@@ -0,0 +1,51 @@
+#include "../sparse_genotypes.hpp"
+
+BURDEN_DECL sparse_genotypes::sparse_genotypes( const int * data,
+						const unsigned & __nrow,
+						const unsigned & __ncol ) : nrow(__nrow),
+									    ncol(0),
+									    colptr(std::vector<size_t>(1,0)),
+									    rowind(std::vector<unsigned>()),
+									    geno(std::vector<int>())
+{
+  add_columns(data,__ncol);
+}
+
+BURDEN_DECL void sparse_genotypes::add_columns( const int * data, const unsigned & __ncol )
+{
+  colptr.reserve(colptr.size()+__ncol);
+  for( unsigned j = 0 ; j < __ncol ; ++j )
+    {
+      for( unsigned i = 0 ; i < nrow ; ++i, ++data )
+	{
+	  if( *data != 0 )
+	    {
+	      rowind.push_back(i);
+	      geno.push_back(*data);
+	    }
+	}
+      colptr.push_back(rowind.size());
+    }
+  ncol += __ncol;
+}
+
+BURDEN_DECL sparse_genotypes::sparse_genotypes( const sparse_genotypes & G,
+						const std::vector<unsigned> & columns ) : nrow(G.nrow),
+										     ncol(columns.size()),
+										     colptr(std::vector<size_t>(1,0)),
+										     rowind(std::vector<unsigned>()),
+										     geno(std::vector<int>())
+{
+  colptr.reserve(ncol+1);
+  for( std::vector<unsigned>::const_iterator j = columns.begin() ; j != columns.end() ; ++j )
+    {
+      rowind.insert(rowind.end(),G.rowind.begin()+G.colptr[*j],G.rowind.begin()+G.colptr[*j+1]);
+      geno.insert(geno.end(),G.geno.begin()+G.colptr[*j],G.geno.begin()+G.colptr[*j+1]);
+      colptr.push_back(rowind.size());
+    }
+}
+
+BURDEN_DECL size_t sparse_genotypes::nnz() const
+{
+  return rowind.size();
+}
@@ -0,0 +1,379 @@
+#include "../stat_multitrait.hpp"
+#include "../cAlpha_variance.hpp"
+#include "../mb_scores.hpp"
+#include "../chisq.hpp"
+#include "../esm_stat.hpp"
+#include "../fisher_exact.hpp"
+#include "../site_patterns.hpp"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <cmath>
+
+BURDEN_DECL stat_multitrait::stat_multitrait( const int * phenotypes,
+					      const unsigned & __n,
+					      const unsigned & __ntraits ) : n(__n),
+									     ntraits(__ntraits),
+									     nwords( (__ntraits+63)/64 ),
+									     trait_bits(std::vector<uint64_t>(size_t(__n)*size_t((__ntraits+63)/64),0)),
+									     ncases(std::vector<unsigned>(__ntraits,0))
+{
+  for( unsigned t = 0 ; t < ntraits ; ++t )
+    {
+      for( unsigned i = 0 ; i < n ; ++i, ++phenotypes )
+	{
+	  if( *phenotypes )
+	    {
+	      trait_bits[size_t(i)*nwords + t/64] |= (uint64_t(1) << (t%64));
+	      ++ncases[t];
+	    }
+	}
+    }
+}
+
+BURDEN_DECL bool stat_multitrait::is_case( const unsigned & i, const unsigned & t ) const
+{
+  return (trait_bits[size_t(i)*nwords + t/64] >> (t%64)) & uint64_t(1);
+}
+
+namespace burden_detail {
+  /*
+    ESM -log10 p-values (log10p[t*stride]), c-alpha terms, Madsen-Browning weights, and
+    Li-Leal "rare" bits of a site, for every trait, given its case counts for each trait.
+    If fisher is not empty, fisher[t] gives the ESM p-values of trait t.
+  */
+  BURDEN_DECL void multitrait_site_values( const unsigned & n,
+					   const std::vector<unsigned> & ncases,
+					   const std::vector<double> & p0,
+					   const unsigned & dosage,
+					   const unsigned & n_i,
+					   const std::vector<unsigned> & case_dosage,
+					   const std::vector<unsigned> & case_carriers,
+					   const double & LLc_maf,
+					   const bool & LLc_maf_control,
+					   const bool & simplecount_calpha,
+					   const std::vector<fisher_exact *> & fisher,
+					   double * log10p, const size_t & stride,
+					   std::vector<double> & cterm,
+					   std::vector<double> & wi,
+					   std::vector<uint64_t> & rare_mask )
+  {
+    std::fill(rare_mask.begin(),rare_mask.end(),0);
+    for( unsigned t = 0 ; t < ncases.size() ; ++t )
+      {
+	const unsigned ncontrols = n - ncases[t], control_minor = dosage - case_dosage[t];
+	//ESM
+	log10p[t*stride] = (fisher.empty()) ? chisq_log10p( control_minor, 2*ncontrols - control_minor,
+							    case_dosage[t], 2*ncases[t] - case_dosage[t] )
+	  : fisher[t]->log10p( dosage, case_dosage[t] );
+	//c-alpha
+	const unsigned y_i = (simplecount_calpha) ? case_carriers[t] : case_dosage[t];
+	cterm[t] = ( std::pow( double(y_i)-double(n_i)*p0[t], 2.) - double(n_i)*p0[t]*(1.-p0[t]) );
+	//Madsen-Browning, with the number of cases in place of the number of controls, as allBurdenStats always has
+	wi[t] = mb_weight(control_minor,ncases[t],n);
+	//Li-Leal
+	if( LLc_maf_control && double(control_minor)/double(2*ncontrols) <= LLc_maf )
+	  {
+	    rare_mask[t/64] |= (uint64_t(1) << (t%64));
+	  }
+      }
+  }
+}
+
+BURDEN_DECL void stat_multitrait::partial( const sparse_genotypes & G,
+					   const double & LLc_maf,
+					   const bool & LLc_maf_control,
+					   const bool & simplecount_calpha,
+					   multitrait_partial & rv,
+					   const site_patterns * patterns,
+					   const bool & esm_fisher ) const
+{
+  const unsigned T = ntraits, W = nwords, m = G.ncol;
+
+  //Only carriers of at least one site can have non-zero scores or carry rare alleles
+  const unsigned NONE = std::numeric_limits<unsigned>::max();
+  std::vector<unsigned> slot(n,NONE);
+  rv.carriers.clear();
+  for( std::vector<unsigned>::const_iterator itr = G.rowind.begin() ; itr != G.rowind.end() ; ++itr )
+    {
+      if( slot[*itr] == NONE )
+	{
+	  slot[*itr] = 0;
+	  rv.carriers.push_back(*itr);
+	}
+    }
+  std::sort(rv.carriers.begin(),rv.carriers.end());
+  const unsigned C = rv.carriers.size();
+  for( unsigned s = 0 ; s < C ; ++s ) slot[rv.carriers[s]] = s;
+
+  std::vector<double> p0(T);
+  for( unsigned t = 0 ; t < T ; ++t )
+    {
+      p0[t] = double(ncases[t])/double(n);
+    }
+
+  rv.nsites = m;
+  rv.LLc_maf_control = LLc_maf_control;
+  rv.log10p.assign(size_t(m)*size_t(T),0.);
+  rv.calphaT.assign(T,0.);
+  rv.ns.clear();
+  rv.mbg.assign(size_t(C)*size_t(T),0.);
+  rv.mbr.assign(size_t(C)*size_t(T),0.);
+  rv.mbd.assign(size_t(C)*size_t(T),0.);
+  rv.rare.assign( (LLc_maf_control) ? size_t(C)*size_t(W) : 0, 0 );
+  rv.rare_all.assign( (LLc_maf_control) ? 0 : C, 0 );
+  std::vector<uint64_t> rare_mask(W);
+  std::vector<double> wi(T),cterm(T);
+  std::vector<unsigned> case_dosage(T),case_carriers(T);
+  //Fisher's test depends on the number of cases, so traits with the same number share a table
+  std::map<unsigned,fisher_exact> fisher_tables;
+  std::vector<fisher_exact *> fisher;
+  if( esm_fisher )
+    {
+      for( unsigned t = 0 ; t < T ; ++t )
+	{
+	  fisher.push_back( &fisher_tables.insert( std::make_pair(ncases[t],fisher_exact(2*n,2*ncases[t])) ).first->second );
+	}
+    }
+
+  /*
+    A site with the same carriers and genotypes as an earlier site has the same values,
+    so only its -log10 p-values, which are kept anyway, and the other values of patterns
+    with more than one site are kept, and copied.
+  */
+  site_patterns own;
+  if( !patterns )
+    {
+      own = site_patterns(G);
+      patterns = &own;
+    }
+  std::vector<unsigned> kept(patterns->npatterns(),NONE);
+  std::vector<double> kept_cterm,kept_wi;
+  std::vector<uint64_t> kept_rare;
+  /*
+    A singleton's values only depend on its genotype and whether its carrier is a case,
+    so for each genotype they are calculated for all traits once, both ways.
+    single_*[2*(g-1)+c] are for genotype g, in a case if c = 1.
+  */
+  bool single_ready[2] = { false, false };
+  std::vector<double> single_log10p[4],single_cterm[4],single_wi[4];
+  std::vector<uint64_t> single_rare[4];
+
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      unsigned dosage = 0, ncarriers = 0;
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  dosage += G.geno[k];
+	  ++ncarriers;
+	}
+      const unsigned n_i = (simplecount_calpha) ? ncarriers : dosage;
+      ++rv.ns[n_i];
+      double * log10p = &rv.log10p[j];
+      const unsigned pat = patterns->pattern[j];
+      if( kept[pat] != NONE )
+	{
+	  //A repeat of an earlier site
+	  const size_t from = size_t(kept[pat]);
+	  const unsigned j0 = patterns->first[pat];
+	  for( unsigned t = 0 ; t < T ; ++t ) log10p[t*size_t(m)] = rv.log10p[t*size_t(m) + j0];
+	  std::copy(kept_cterm.begin()+from*T,kept_cterm.begin()+(from+1)*T,cterm.begin());
+	  std::copy(kept_wi.begin()+from*T,kept_wi.begin()+(from+1)*T,wi.begin());
+	  std::copy(kept_rare.begin()+from*W,kept_rare.begin()+(from+1)*W,rare_mask.begin());
+	}
+      else if( ncarriers == 1 )
+	{
+	  const unsigned g = G.geno[G.colptr[j]];
+	  if( !single_ready[g-1] )
+	    {
+	      for( unsigned c = 0 ; c < 2 ; ++c )
+		{
+		  const unsigned v = 2*(g-1)+c;
+		  std::fill(case_dosage.begin(),case_dosage.end(),c*g);
+		  std::fill(case_carriers.begin(),case_carriers.end(),c);
+		  single_log10p[v].resize(T);
+		  single_cterm[v].resize(T);
+		  single_wi[v].resize(T);
+		  single_rare[v].resize(W);
+		  burden_detail::multitrait_site_values(n,ncases,p0,g,n_i,case_dosage,case_carriers,
+							LLc_maf,LLc_maf_control,simplecount_calpha,fisher,
+							&single_log10p[v][0],1,single_cterm[v],single_wi[v],single_rare[v]);
+		}
+	      single_ready[g-1] = true;
+	    }
+	  const uint64_t * bits = &trait_bits[size_t(G.rowind[G.colptr[j]])*W];
+	  std::fill(rare_mask.begin(),rare_mask.end(),0);
+	  for( unsigned t = 0 ; t < T ; ++t )
+	    {
+	      const unsigned v = 2*(g-1) + unsigned( (bits[t/64] >> (t%64)) & uint64_t(1) );
+	      log10p[t*size_t(m)] = single_log10p[v][t];
+	      cterm[t] = single_cterm[v][t];
+	      wi[t] = single_wi[v][t];
+	      rare_mask[t/64] |= single_rare[v][t/64] & (uint64_t(1) << (t%64));
+	    }
+	}
+      else
+	{
+	  //Case allele and carrier counts for every trait
+	  std::fill(case_dosage.begin(),case_dosage.end(),0);
+	  std::fill(case_carriers.begin(),case_carriers.end(),0);
+	  for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	    {
+	      const unsigned g = G.geno[k];
+	      const uint64_t * bits = &trait_bits[size_t(G.rowind[k])*W];
+	      for( unsigned t = 0 ; t < T ; ++t )
+		{
+		  if( (bits[t/64] >> (t%64)) & uint64_t(1) )
+		    {
+		      case_dosage[t] += g;
+		      ++case_carriers[t];
+		    }
+		}
+	    }
+	  burden_detail::multitrait_site_values(n,ncases,p0,dosage,n_i,case_dosage,case_carriers,
+						LLc_maf,LLc_maf_control,simplecount_calpha,fisher,
+						log10p,m,cterm,wi,rare_mask);
+	}
+      if( kept[pat] == NONE && patterns->count[pat] > 1 )
+	{
+	  kept[pat] = unsigned(kept_cterm.size()/std::max(T,1u));
+	  kept_cterm.insert(kept_cterm.end(),cterm.begin(),cterm.end());
+	  kept_wi.insert(kept_wi.end(),wi.begin(),wi.end());
+	  kept_rare.insert(kept_rare.end(),rare_mask.begin(),rare_mask.end());
+	}
+      for( unsigned t = 0 ; t < T ; ++t ) rv.calphaT[t] += cterm[t];
+      const bool site_rare = ( !LLc_maf_control && double(dosage)/double(2*n) <= LLc_maf );
+
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  const unsigned s = slot[G.rowind[k]];
+	  const double g = double(G.geno[k]);
+	  const bool hom = (G.geno[k] == 2);
+	  double * sg = &rv.mbg[size_t(s)*T], * sr = &rv.mbr[size_t(s)*T], * sd = &rv.mbd[size_t(s)*T];
+	  for( unsigned t = 0 ; t < T ; ++t )
+	    {
+	      sg[t] += g/wi[t];
+	      sd[t] += 1./wi[t];
+	      if( hom ) sr[t] += 1./wi[t];
+	    }
+	  if( LLc_maf_control )
+	    {
+	      for( unsigned w = 0 ; w < W ; ++w ) rv.rare[size_t(s)*W + w] |= rare_mask[w];
+	    }
+	  else if( site_rare )
+	    {
+	      rv.rare_all[s] = 1;
+	    }
+	}
+    }
+}
+
+BURDEN_DECL void stat_multitrait::combine( const std::vector<const multitrait_partial *> & parts,
+					   const unsigned & esm_K,
+					   const bool & normalize_calpha,
+					   multitrait_values & rv ) const
+{
+  const unsigned T = ntraits, W = nwords;
+  const bool LLc_maf_control = parts.empty() || parts[0]->LLc_maf_control;
+
+  //The union of the parts' carriers, and each part's carriers' places in it
+  std::vector<unsigned> carriers;
+  unsigned m = 0;
+  for( unsigned p = 0 ; p < parts.size() ; ++p )
+    {
+      carriers.insert(carriers.end(),parts[p]->carriers.begin(),parts[p]->carriers.end());
+      m += parts[p]->nsites;
+    }
+  std::sort(carriers.begin(),carriers.end());
+  carriers.erase(std::unique(carriers.begin(),carriers.end()),carriers.end());
+  const unsigned C = carriers.size();
+
+  std::vector<double> calphaT(T,0.);
+  std::map<unsigned,unsigned> ns;
+  std::vector<double> mbg(size_t(C)*size_t(T),0.),mbr(size_t(C)*size_t(T),0.),mbd(size_t(C)*size_t(T),0.);
+  std::vector<uint64_t> rare( (LLc_maf_control) ? size_t(C)*size_t(W) : 0, 0 );
+  std::vector<char> rare_all( (LLc_maf_control) ? 0 : C, 0 );
+  for( unsigned p = 0 ; p < parts.size() ; ++p )
+    {
+      const multitrait_partial & P = *parts[p];
+      for( unsigned t = 0 ; t < T ; ++t ) calphaT[t] += P.calphaT[t];
+      for( std::map<unsigned,unsigned>::const_iterator itr = P.ns.begin() ; itr != P.ns.end() ; ++itr )
+	{
+	  ns[itr->first] += itr->second;
+	}
+      //Both lists of carriers are sorted, so one forward scan finds every slot
+      std::vector<unsigned>::iterator pos = carriers.begin();
+      for( unsigned c = 0 ; c < P.carriers.size() ; ++c )
+	{
+	  pos = std::lower_bound(pos,carriers.end(),P.carriers[c]);
+	  const size_t s = size_t(pos - carriers.begin());
+	  for( unsigned t = 0 ; t < T ; ++t )
+	    {
+	      mbg[s*T + t] += P.mbg[size_t(c)*T + t];
+	      mbr[s*T + t] += P.mbr[size_t(c)*T + t];
+	      mbd[s*T + t] += P.mbd[size_t(c)*T + t];
+	    }
+	  if( LLc_maf_control )
+	    {
+	      for( unsigned w = 0 ; w < W ; ++w ) rare[s*W + w] |= P.rare[size_t(c)*W + w];
+	    }
+	  else if( P.rare_all[c] )
+	    {
+	      rare_all[s] = 1;
+	    }
+	}
+    }
+
+  rv.esm.resize(T);
+  rv.calpha.resize(T);
+  rv.MBg.resize(T);
+  rv.MBr.resize(T);
+  rv.MBd.resize(T);
+  rv.LLc.resize(T);
+  mb_rank_engine ranker;
+  std::vector<double> log10p(m);
+  for( unsigned t = 0 ; t < T ; ++t )
+    {
+      std::vector<double>::iterator out = log10p.begin();
+      for( unsigned p = 0 ; p < parts.size() ; ++p )
+	{
+	  const size_t mp = parts[p]->nsites;
+	  out = std::copy(parts[p]->log10p.begin() + t*mp, parts[p]->log10p.begin() + (t+1)*mp, out);
+	}
+      rv.esm[t] = esm_stat( log10p, esm_K );
+      const double p0 = double(ncases[t])/double(n);
+      rv.calpha[t] = (normalize_calpha) ? calphaT[t]/std::sqrt(cAlpha_Z(ns,p0)) : calphaT[t];
+
+      ranker.clear();
+      unsigned co = 0, ca = 0;
+      for( unsigned s = 0 ; s < C ; ++s )
+	{
+	  const size_t k = size_t(s)*T + t;
+	  const bool iscase = is_case(carriers[s],t);
+	  ranker.push_back(mbg[k],mbr[k],mbd[k],iscase);
+	  const bool has_rare = (LLc_maf_control) ? bool( (rare[size_t(s)*W + t/64] >> (t%64)) & uint64_t(1) ) : bool(rare_all[s]);
+	  if( has_rare )
+	    {
+	      if( iscase ) ++ca;
+	      else ++co;
+	    }
+	}
+      ranker(n,ncases[t],rv.MBg[t],rv.MBr[t],rv.MBd[t]);
+      rv.LLc[t] = chisq(co,n-ncases[t]-co,ca,ncases[t]-ca);
+    }
+}
+
+BURDEN_DECL void stat_multitrait::operator()( const sparse_genotypes & G,
+					      const unsigned & esm_K,
+					      const double & LLc_maf,
+					      const bool & LLc_maf_control,
+					      const bool & normalize_calpha,
+					      const bool & simplecount_calpha,
+					      multitrait_values & rv,
+					      const site_patterns * patterns,
+					      const bool & esm_fisher ) const
+{
+  multitrait_partial part;
+  partial(G,LLc_maf,LLc_maf_control,simplecount_calpha,part,patterns,esm_fisher);
+  combine(std::vector<const multitrait_partial *>(1,&part),esm_K,normalize_calpha,rv);
+}
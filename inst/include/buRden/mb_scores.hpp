@@ -0,0 +1,89 @@
+#ifndef __MB_SCORES_HPP__
+#define __MB_SCORES_HPP__
+
+#include "config.hpp"
+#include "sparse_genotypes.hpp"
+#include <vector>
+#include <utility>
+
+/*
+  Madsen-Browning scores as a sparse, weighted matrix-vector product.
+
+  An individual's score is sum_j g_ij/w_j, where w_j = sqrt(n*q_j*(1-q_j)) and
+  q_j is estimated from the minor allele count of site j in controls.  Only
+  carriers (g_ij > 0) contribute, so a site costs O(carriers) rather than O(n).
+  The recessive and dominant scores use indicators of g_ij == 2 and g_ij > 0.
+
+  The scores are accumulated site by site, dividing by w_j, in the same order
+  as the dense calculation, so that results are identical to the last bit.
+ */
+
+//The divisor w_j for a site with minor_count minor alleles among ncontrols controls, out of n individuals
+BURDEN_DECL double mb_weight( const unsigned & minor_count, const unsigned & ncontrols, const unsigned & n );
+
+//Add one site's carriers to the scores under all three models
+BURDEN_DECL void mb_add_site( const std::vector<unsigned> & ind,
+			      const std::vector<int> & geno,
+			      const double & wi,
+			      std::vector<double> & scores,
+			      std::vector<double> & scores_rec,
+			      std::vector<double> & scores_dom );
+
+/*
+  Scores for a block of B labellings of the same individuals at once.  labels
+  is n x B and row-major (labels[i*B+b] is individual i in labelling b), and
+  the scores are returned in the same layout.  For each site, the control
+  counts under every labelling give B weights, and the site's carriers are
+  then multiplied into the whole block of weights.
+ */
+BURDEN_DECL void mb_scores_block( const sparse_genotypes & G,
+				  const std::vector<int> & labels,
+				  const unsigned & B,
+				  const unsigned & ncontrols,
+				  std::vector<double> & scores,
+				  std::vector<double> & scores_rec,
+				  std::vector<double> & scores_dom );
+
+/*
+  Rank sums of the cases' scores under all three models, with ties given the
+  minimum rank: the rank of x is 1 + the number of scores < x, the same as
+  lower_bound on sorted scores.
+
+  Only carriers can have non-zero scores, so everyone else is one block of tied
+  zeros whose rank is known without sorting.  Only the carriers' scores are
+  sorted, and a rank sum costs O(c log c) for c carriers, rather than O(n log n).
+  Fill the engine with the carriers' scores, then call operator().  The buffers
+  are reused, so one engine can be used for many permutations.
+
+  A site whose weight is 0, NaN, or infinite gives its carriers scores that are
+  not finite.  If any carrier's score is not finite, all three statistics are
+  NaN, as they are for such a window in window_scan.  The weights of the
+  allBurdenStats family use the number of cases in place of the number of
+  controls, so this happens when a site has more than 2*ncases+1 minor alleles
+  in controls.
+ */
+class mb_rank_engine
+{
+private:
+  std::vector<double> general,recessive,dominant;
+  std::vector<int> is_case;
+  std::vector< std::pair<double,int> > work;
+  double ranksum( const std::vector<double> & carrier_scores,
+		  const unsigned & n,
+		  const unsigned & ncases );
+  //True if every carrier's scores are finite
+  bool finite() const;
+public:
+  void clear();
+  //Add a carrier
+  void push_back( const double & score, const double & score_rec, const double & score_dom, const bool & iscase );
+  //n and ncases are the total numbers of individuals and cases, carriers or not
+  void operator()( const unsigned & n, const unsigned & ncases,
+		   double & stat, double & stat_rec, double & stat_dom );
+};
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/mb_scores.ipp"
+#endif
+
+#endif
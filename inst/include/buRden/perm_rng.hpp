@@ -0,0 +1,49 @@
+#ifndef __PERM_RNG_HPP__
+#define __PERM_RNG_HPP__
+
+#include "config.hpp"
+#include <stdint.h>
+#include <algorithm>
+
+/*
+  A small, seedable random number generator for permutation streams.
+
+  R's RNG cannot be split into independent streams, so permutations that
+  must be reproducible across processes use this instead.  The generator
+  is SplitMix64.  Each permutation gets its own stream, obtained by hashing
+  (seed,stream), which means that permutation i is the same no matter which
+  process (or shard) ends up computing it.
+ */
+class perm_rng
+{
+private:
+  uint64_t state;
+public:
+  perm_rng( const uint64_t & seed, const uint64_t & stream = 0 );
+  //Returns the next 64 random bits
+  uint64_t next();
+  //Returns a uniform integer in [0,n), with no modulo bias
+  unsigned operator()(const unsigned & n);
+  //Returns a uniform double in [0,1)
+  double uniform();
+};
+
+/*
+  Fisher-Yates shuffle driven by a perm_rng.  We don't use std::random_shuffle here
+  because its algorithm differs between standard libraries, and shards of the same
+  permutation stream may be run on machines built with different compilers.
+ */
+template<typename iterator>
+void perm_shuffle( iterator beg, iterator end, perm_rng & rng )
+{
+  for( unsigned n = unsigned(end-beg) ; n > 1 ; --n )
+    {
+      std::swap( *(beg+(n-1)), *(beg+rng(n)) );
+    }
+}
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/perm_rng.ipp"
+#endif
+
+#endif
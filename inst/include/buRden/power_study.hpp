@@ -0,0 +1,127 @@
+#ifndef __POWER_STUDY_HPP__
+#define __POWER_STUDY_HPP__
+
+#include "config.hpp"
+#include "sparse_genotypes.hpp"
+#include "site_patterns.hpp"
+#include "stat_multitrait.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+  Permutation p-values of all burden statistics for one simulated replicate,
+  as used by the power study driver (see power.cc).
+
+  Permutation i of replicate r is generated by perm_rng(seed, r*2^32 + i), so a
+  replicate's p-values depend only on its data, its index, and the seed, and
+  not on which thread processes it or in what order.  Permutations are scored
+  in blocks by stat_multitrait, so each block is one pass over the genotypes.
+
+  Nothing here uses R, so replicates may be processed by worker threads.
+ */
+
+//Number of statistics, in the order of allBurdenStats: esm, calpha, MB general/recessive/dominant, LL collapse
+const unsigned POWER_NSTATS = 6;
+
+//Number of permutations scored in one pass over the genotypes
+const unsigned POWER_PERM_BLOCK = 64;
+
+struct power_params
+{
+  unsigned nperms,esm_K;
+  double LLc_maf;
+  bool LLc_maf_control,normalize_calpha,simplecount_calpha;
+  //If true, ESM_K uses Fisher's exact test for each marker in place of the chi-squared test
+  bool esm_fisher;
+  uint64_t seed;
+};
+
+struct power_replicate
+{
+  //column-major, nrow x ncol
+  std::vector<int> genos;
+  unsigned nrow,ncol;
+  std::vector<int> status;
+  power_replicate();
+};
+
+/*
+  Observed statistics and Monte-carlo p-values of one block of genotypes, which
+  is nrow x ncol and column-major.  Permutations use the streams of replicate r.
+  If par.nperms is 0, only the observed statistics are calculated, and p is NaN.
+  Returns false, and sets error, if the data are not valid.
+ */
+BURDEN_DECL bool burden_block_test( const int * genos,
+				    const unsigned & nrow,
+				    const unsigned & ncol,
+				    const int * status,
+				    const uint64_t & r,
+				    const power_params & par,
+				    std::vector<double> & observed,
+				    std::vector<double> & p,
+				    std::string & error );
+
+/*
+  Same, for genotypes already in sparse form and known to be 0, 1, or 2.  If
+  cancel is not 0, it is checked between blocks of permutations, and the test
+  stops, returning false with error set to "cancelled", once *cancel is non-zero.
+ */
+BURDEN_DECL bool burden_sparse_test( const sparse_genotypes & G,
+				     const int * status,
+				     const uint64_t & r,
+				     const power_params & par,
+				     std::vector<double> & observed,
+				     std::vector<double> & p,
+				     std::string & error,
+				     const std::atomic<int> * cancel = 0 );
+
+/*
+  Statistics of permutations first through first+B-1 of replicate r: element b
+  of each statistic in perm is for permutation first+b.  The genotypes must be
+  0, 1, or 2 and the labels 0 or 1.  labels is scratch space.  patterns, if
+  not 0, must be site_patterns(G), found once for all blocks.
+ */
+BURDEN_DECL void burden_perm_values( const sparse_genotypes & G,
+				     const int * status,
+				     const uint64_t & r,
+				     const unsigned & first,
+				     const unsigned & B,
+				     const power_params & par,
+				     multitrait_values & perm,
+				     std::vector<int> & labels,
+				     const site_patterns * patterns = 0 );
+
+/*
+  Scores permutations first through first+B-1 of replicate r, adding to nexceed[j]
+  the number of permuted values of statistic j that are >= observed[j].  The
+  arguments are as for burden_perm_values.
+ */
+BURDEN_DECL void burden_perm_block( const sparse_genotypes & G,
+				    const int * status,
+				    const uint64_t & r,
+				    const unsigned & first,
+				    const unsigned & B,
+				    const power_params & par,
+				    const std::vector<double> & observed,
+				    std::vector<unsigned> & nexceed,
+				    std::vector<int> & labels,
+				    const site_patterns * patterns = 0 );
+
+/*
+  Fills p with the Monte-carlo p-values, (number of permuted values >= observed)/nperms.
+  A statistic whose observed value is NaN gets a p-value of NaN.
+  Returns false, and sets error, if the data are not valid.
+ */
+BURDEN_DECL bool power_replicate_p( const power_replicate & rep,
+				    const uint64_t & r,
+				    const power_params & par,
+				    std::vector<double> & p,
+				    std::string & error );
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/power_study.ipp"
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __SITE_PATTERNS_HPP__
+#define __SITE_PATTERNS_HPP__
+
+#include "config.hpp"
+#include "sparse_genotypes.hpp"
+#include <vector>
+
+/*
+  The sites of a sparse_genotypes, grouped by carrier pattern.
+
+  Two sites have the same pattern if they have the same carriers with the same
+  genotypes.  For any labelling, such sites have the same case and control
+  counts, and so the same per-site test statistics, so stat_multitrait only
+  calculates them for the first site with each pattern.  Rare-variant data
+  have many such sites, and the patterns do not depend on the labels, so they
+  are found once and used for every block of permutations.
+
+  Patterns are numbered in order of their first site.  Finding them costs
+  O(carriers) plus a sort of the sites by a hash of their patterns.
+ */
+struct site_patterns
+{
+  //pattern[j] is the pattern of site j
+  std::vector<unsigned> pattern;
+  //first[p] is the first site with pattern p, and count[p] the number of sites with it
+  std::vector<unsigned> first,count;
+  site_patterns();
+  explicit site_patterns( const sparse_genotypes & G );
+  unsigned npatterns() const;
+};
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/site_patterns.ipp"
+#endif
+
+#endif
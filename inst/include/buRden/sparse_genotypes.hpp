@@ -0,0 +1,39 @@
+#ifndef __SPARSE_GENOTYPES_HPP__
+#define __SPARSE_GENOTYPES_HPP__
+
+#include "config.hpp"
+#include <cstddef>
+#include <vector>
+
+/*
+  Compressed sparse column (CSC) copy of a genotype matrix.
+
+  Rare-variant data are mostly zeros, so only the non-zero genotypes (the
+  carriers) of each site are kept.  The carriers of site j are
+  rowind[colptr[j]] through rowind[colptr[j+1]-1], and geno holds their
+  genotypes.  Rows within a site are in increasing order.
+
+  Row and column indexes fit R's matrix dimensions, but a large cohort may
+  have more than 2^32 carriers in all, so offsets into rowind and geno are size_t.
+ */
+class sparse_genotypes
+{
+public:
+  unsigned nrow,ncol;
+  std::vector<size_t> colptr;
+  std::vector<unsigned> rowind;
+  std::vector<int> geno;
+  //data is column-major, like an R matrix
+  sparse_genotypes( const int * data, const unsigned & __nrow, const unsigned & __ncol );
+  //The given columns of G, in the given order.  Costs O(carriers of those columns).
+  sparse_genotypes( const sparse_genotypes & G, const std::vector<unsigned> & columns );
+  //Appends ncol columns of nrow genotypes (column-major), so a large matrix may be converted a block of columns at a time
+  void add_columns( const int * data, const unsigned & __ncol );
+  size_t nnz() const;
+};
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/sparse_genotypes.ipp"
+#endif
+
+#endif
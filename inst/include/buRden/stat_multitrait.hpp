@@ -0,0 +1,107 @@
+#ifndef __STAT_MULTITRAIT_HPP__
+#define __STAT_MULTITRAIT_HPP__
+
+#include "config.hpp"
+#include "sparse_genotypes.hpp"
+#include "site_patterns.hpp"
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+/*
+  All burden statistics for many binary phenotypes, in one pass over the genotypes.
+
+  The phenotypes are packed into bits: bit t of individual i's words is 1 if
+  i is a case for trait t.  For each site, the carriers' bits give the case
+  allele and carrier counts for every trait at once.  These are the sufficient
+  statistics for ESM, c-alpha, and the Madsen-Browning weights and Li-Leal MAFs.
+  Madsen-Browning scores and Li-Leal carrier status are only kept for carriers.
+
+  Each trait gets exactly the values that allBurdenStats returns for it, so
+  the cost of reading the genotypes no longer grows with the number of traits.
+  Permuted labels are "traits", too, so a block of permutations is also one pass.
+
+  Per-site values are only calculated once for each carrier pattern (see
+  site_patterns), and a singleton's values are looked up from its genotype and
+  whether its carrier is a case.  Sites are still added up one at a time, in
+  order, so the results do not depend on how the sites are grouped.
+
+  No R objects are used, so different threads may use different instances.
+  Callers must check that labels are 0 or 1, and that genotypes are 0, 1, or 2.
+ */
+struct multitrait_values
+{
+  std::vector<double> esm,calpha,MBg,MBr,MBd,LLc;
+};
+
+/*
+  What a group of sites (e.g. a gene) contributes to the statistics of any larger
+  group that contains it, for every trait: the sites' -log10 p-values (for ESM),
+  c-alpha terms and counts of sites by number of observations, and the carriers'
+  Madsen-Browning scores and Li-Leal "rare" status.  Partial values of groups with
+  no sites in common are combined without reading the genotypes again.  The scores
+  of the union are sums of the groups' scores, which may differ in the last bits
+  from sums over sites, and so may break or make a tie in the Madsen-Browning ranks.
+ */
+struct multitrait_partial
+{
+  unsigned nsites;
+  bool LLc_maf_control;
+  //traits x sites, column-major
+  std::vector<double> log10p;
+  std::vector<double> calphaT;
+  std::map<unsigned,unsigned> ns;
+  //individuals carrying at least one site, in increasing order
+  std::vector<unsigned> carriers;
+  //carriers x traits, row-major
+  std::vector<double> mbg,mbr,mbd;
+  //per trait bits if LLc_maf_control, otherwise one flag per carrier
+  std::vector<uint64_t> rare;
+  std::vector<char> rare_all;
+};
+
+class stat_multitrait
+{
+private:
+  unsigned n,ntraits,nwords;
+  std::vector<uint64_t> trait_bits;
+  std::vector<unsigned> ncases;
+  bool is_case( const unsigned & i, const unsigned & t ) const;
+public:
+  //phenotypes is individuals x traits and column-major, coded as 0 (control) or 1 (case)
+  stat_multitrait( const int * phenotypes, const unsigned & __n, const unsigned & __ntraits );
+  /*
+    The contribution of the sites of G.  patterns, if not 0, must be site_patterns(G).
+    Pass it when G is scored many times, such as once per block of permutations,
+    so that the patterns are only found once.  If esm_fisher is true, ESM uses
+    Fisher's exact test of each site (see fisher_exact) in place of the chi-squared.
+  */
+  void partial( const sparse_genotypes & G,
+		const double & LLc_maf,
+		const bool & LLc_maf_control,
+		const bool & simplecount_calpha,
+		multitrait_partial & rv,
+		const site_patterns * patterns = 0,
+		const bool & esm_fisher = false ) const;
+  //The statistics of the union of the groups of sites in parts, which must have been made with the same LLc_maf_control
+  void combine( const std::vector<const multitrait_partial *> & parts,
+		const unsigned & esm_K,
+		const bool & normalize_calpha,
+		multitrait_values & rv ) const;
+  //Element t of each statistic is the value for trait t.  patterns and esm_fisher are as for partial.
+  void operator()( const sparse_genotypes & G,
+		   const unsigned & esm_K,
+		   const double & LLc_maf,
+		   const bool & LLc_maf_control,
+		   const bool & normalize_calpha,
+		   const bool & simplecount_calpha,
+		   multitrait_values & rv,
+		   const site_patterns * patterns = 0,
+		   const bool & esm_fisher = false ) const;
+};
+
+#ifndef BURDEN_SEPARATE_COMPILATION
+#include "impl/stat_multitrait.ipp"
+#endif
+
+#endif
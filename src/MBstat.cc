@@ -2,14 +2,84 @@
 #include <stat_MadsenBrowning.hpp>
 #include <stat_calculator.hpp>
 #include <randWrapper.hpp>
+#include <sparse_genotypes.hpp>
+#include <mb_scores.hpp>
+#include <validate.hpp>
 #include <algorithm>
 #include <numeric>
-#include <functional>
 #include <vector>
 
 using namespace Rcpp;
 using namespace std;
 
+namespace {
+  //Number of permutations whose scores are calculated together by MB_perm
+  const unsigned MB_PERM_BLOCK = 32;
+
+  /*
+    The permutation distributions of MB_perm and MB_perm_plan.  fill(first,B,labels)
+    sets labels[i*B+b] to the label of individual i in permutation first+b.
+  */
+  template<typename label_filler>
+  DataFrame mb_perm( const IntegerMatrix & ccdata,
+		     const IntegerVector & ccstatus,
+		     const unsigned & nperms,
+		     label_filler fill )
+  {
+    NumericVector g(nperms),d(nperms),r(nperms);
+    const unsigned n = ccdata.nrow(),
+      ncontrols = count(ccstatus.begin(),ccstatus.end(),0);
+
+    sparse_genotypes G(ccdata.begin(),n,ccdata.ncol());
+    for( vector<int>::const_iterator itr = G.geno.begin() ; itr != G.geno.end() ; ++itr )
+      {
+	if( *itr != 1 && *itr != 2 )
+	  {
+	    stop("MBstat: genotype code other than 0, 1, or 2 is not allowed!");
+	  }
+      }
+
+    //Individuals with a non-zero genotype at any site are the only ones whose scores can be non-zero
+    vector<unsigned> carriers;
+    {
+      vector<char> carrier(n,0);
+      for( vector<unsigned>::const_iterator itr = G.rowind.begin() ; itr != G.rowind.end() ; ++itr ) carrier[*itr] = 1;
+      for( unsigned i = 0 ; i < n ; ++i ) if( carrier[i] ) carriers.push_back(i);
+    }
+    const unsigned ncases = count(ccstatus.begin(),ccstatus.end(),1);
+
+    vector<int> labels;
+    vector<double> s,s_rec,s_dom;
+    mb_rank_engine ranker;
+    for( unsigned first = 0 ; first < nperms ; first += MB_PERM_BLOCK )
+      {
+	const unsigned B = min(MB_PERM_BLOCK,nperms-first);
+	labels.resize(size_t(n)*B);
+	fill(first,B,labels);
+	mb_scores_block(G,labels,B,ncontrols,s,s_rec,s_dom);
+	for( unsigned b = 0 ; b < B ; ++b )
+	  {
+	    ranker.clear();
+	    for( vector<unsigned>::const_iterator itr = carriers.begin() ; itr != carriers.end() ; ++itr )
+	      {
+		const size_t k = size_t(*itr)*B+b;
+		ranker.push_back(s[k],s_rec[k],s_dom[k],labels[k]==1);
+	      }
+	    double stat,stat_rec,stat_dom;
+	    ranker(n,ncases,stat,stat_rec,stat_dom);
+	    g[first+b] = stat;
+	    r[first+b] = stat_rec;
+	    d[first+b] = stat_dom;
+	  }
+	checkUserInterrupt();
+      }
+
+    return DataFrame::create( Named("general") = g,
+			      Named("recessive") = r,
+			      Named("dominant") = d );
+  }
+}
+
 //' Calculate Madsen-Browning weights.
 //' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
@@ -64,6 +134,9 @@ Rcpp::List MBstat( const IntegerMatrix & ccdata,
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case. 
 //' @param nperms The number of permutations to perform
 //' @return A data frame of permuted statistics
+//' @details The genotypes are stored sparsely, and the scores for blocks of permutations are calculated together, as the product of the
+//' sparse genotype matrix and a block of per-permutation site weights.  The permutations and the statistics are the same as calling MBstat
+//' on each permuted set of labels.
 //' @references Madsen, B. E., & Browning, S. R. (2009). A groupwise association test for rare mutations using a weighted sum statistic. PLoS Genetics, 5(2), e1000384. doi:10.1371/journal.pgen.1000384
 //' @examples
 //' data(rec.ccdata)
@@ -77,20 +150,50 @@ DataFrame MB_perm( const IntegerMatrix & ccdata,
 		   const IntegerVector & ccstatus,
 		   const unsigned & nperms )
 {
-  NumericVector g(nperms),d(nperms),r(nperms);
   RNGScope scope;
   IntegerVector status = clone(ccstatus);
- 
-  for( unsigned i = 0 ; i < nperms ; ++i )
+  //Permutations are scored in blocks, using the same sequence of shuffles as one at a time
+  return mb_perm(ccdata,ccstatus,nperms,
+		 [&status]( const unsigned &, const unsigned & B, vector<int> & labels ) {
+		   const unsigned n = status.size();
+		   for( unsigned b = 0 ; b < B ; ++b )
+		     {
+		       random_shuffle(status.begin(),status.end(),randWrapper);
+		       for( unsigned i = 0 ; i < n ; ++i ) labels[size_t(i)*B+b] = status[i];
+		     }
+		 });
+}
+
+//' Permutation distribution of Madsen-Browning test statistics from a permutation plan
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @return A data frame of permuted statistics, the same as MB_perm, with one row per permutation of the plan.
+//' @details ccstatus is only used to check that the plan has the same numbers of individuals and cases.  The labels of each block of
+//' permutations are read from the plan's bits as they are needed.
+//' @references Madsen, B. E., & Browning, S. R. (2009). A groupwise association test for rare mutations using a weighted sum statistic. PLoS Genetics, 5(2), e1000384. doi:10.1371/journal.pgen.1000384
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' plan = permPlan(status,100,101)
+//' mbstats.perm = MB_perm_plan( rec.ccdata$genos[,which(keep==1)], status, plan )
+// [[Rcpp::export]]
+DataFrame MB_perm_plan( const IntegerMatrix & ccdata,
+			const IntegerVector & ccstatus,
+			XPtr<perm_plan> plan )
+{
+  if( ccstatus.size() != ccdata.nrow() )
     {
-      random_shuffle(status.begin(),status.end(),randWrapper);
-      List mbstats = MBstat( ccdata, status );
-      g[i] = as<double>(mbstats["general"]);
-      d[i] = as<double>(mbstats["dominant"]);
-      r[i] = as<double>(mbstats["recessive"]);
+      stop("MB_perm_plan: length(ccstatus) != nrow(ccdata)");
     }
-
-  return DataFrame::create( Named("general") = g,
-			    Named("recessive") = r,
-			    Named("dominant") = d );
+  const perm_plan * p = validate_plan(plan,ccstatus,"MB_perm_plan");
+  return mb_perm(ccdata,ccstatus,p->nperms,
+		 [p]( const unsigned & first, const unsigned & B, vector<int> & labels ) {
+		   for( unsigned b = 0 ; b < B ; ++b )
+		     {
+		       const unsigned char * bits = p->packed(first+b);
+		       for( unsigned i = 0 ; i < p->n ; ++i ) labels[size_t(i)*B+b] = ( bits[i/8] >> (i%8) ) & 1;
+		     }
+		 });
 }
@@ -2,12 +2,13 @@
 // Generator token: 10BE3573-1514-4C36-9D1C-5A225CD40393
 
 #include <Rcpp.h>
+#include "buRden_types.h"
 
 using namespace Rcpp;
 
 // allBurdenStats
-List allBurdenStats(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha);
-RcppExport SEXP buRden_allBurdenStats(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP) {
+List allBurdenStats(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStats(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP esm_fisherSEXP) {
 BEGIN_RCPP
     Rcpp::RObject __result;
     Rcpp::RNGScope __rngScope;
@@ -18,13 +19,32 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
     Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
     Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
-    __result = Rcpp::wrap(allBurdenStats(ccdata, ccstatus, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha));
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStats(ccdata, ccstatus, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, esm_fisher));
+    return __result;
+END_RCPP
+}
+// allBurdenStatsMulti
+DataFrame allBurdenStatsMulti(const IntegerMatrix& ccdata, const IntegerMatrix& phenotypes, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsMulti(SEXP ccdataSEXP, SEXP phenotypesSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type phenotypes(phenotypesSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsMulti(ccdata, phenotypes, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, esm_fisher));
     return __result;
 END_RCPP
 }
 // allBurdenStatsPerm
-List allBurdenStatsPerm(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha);
-RcppExport SEXP buRden_allBurdenStatsPerm(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP) {
+List allBurdenStatsPerm(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsPerm(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP esm_fisherSEXP) {
 BEGIN_RCPP
     Rcpp::RObject __result;
     Rcpp::RNGScope __rngScope;
@@ -36,7 +56,67 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
     Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
     Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
-    __result = Rcpp::wrap(allBurdenStatsPerm(ccdata, ccstatus, nperms, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha));
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsPerm(ccdata, ccstatus, nperms, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, esm_fisher));
+    return __result;
+END_RCPP
+}
+// allBurdenStatsPermRange
+List allBurdenStatsPermRange(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& first, const unsigned& last, const unsigned& seed, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const unsigned& tail_size, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsPermRange(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP firstSEXP, SEXP lastSEXP, SEXP seedSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP tail_sizeSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type last(lastSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type tail_size(tail_sizeSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsPermRange(ccdata, ccstatus, first, last, seed, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, tail_size, esm_fisher));
+    return __result;
+END_RCPP
+}
+// allBurdenStatsPermShard
+List allBurdenStatsPermShard(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& nshards, const unsigned& shard, const unsigned& seed, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const unsigned& tail_size, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsPermShard(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP nshardsSEXP, SEXP shardSEXP, SEXP seedSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP tail_sizeSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nshards(nshardsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type shard(shardSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type tail_size(tail_sizeSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsPermShard(ccdata, ccstatus, nperms, nshards, shard, seed, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, tail_size, esm_fisher));
+    return __result;
+END_RCPP
+}
+// burden_cache_key
+std::string burden_cache_key(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const std::string& what, const NumericVector& params);
+RcppExport SEXP buRden_burden_cache_key(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP whatSEXP, SEXP paramsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type what(whatSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type params(paramsSEXP);
+    __result = Rcpp::wrap(burden_cache_key(ccdata, ccstatus, what, params));
     return __result;
 END_RCPP
 }
@@ -68,6 +148,33 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// cAlpha_perm_plan
+NumericVector cAlpha_perm_plan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, XPtr<perm_plan> plan, const bool& simplecounts);
+RcppExport SEXP buRden_cAlpha_perm_plan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP planSEXP, SEXP simplecountsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type simplecounts(simplecountsSEXP);
+    __result = Rcpp::wrap(cAlpha_perm_plan(ccdata, ccstatus, plan, simplecounts));
+    return __result;
+END_RCPP
+}
+// cAlpha_test
+List cAlpha_test(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const bool& simplecounts);
+RcppExport SEXP buRden_cAlpha_test(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP simplecountsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type simplecounts(simplecountsSEXP);
+    __result = Rcpp::wrap(cAlpha_test(ccdata, ccstatus, simplecounts));
+    return __result;
+END_RCPP
+}
 // chisq
 double chisq(const unsigned& a, const unsigned& b, const unsigned& c, const unsigned& d, const bool& yates);
 RcppExport SEXP buRden_chisq(SEXP aSEXP, SEXP bSEXP, SEXP cSEXP, SEXP dSEXP, SEXP yatesSEXP) {
@@ -95,6 +202,28 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// fisher_per_marker
+NumericVector fisher_per_marker(const IntegerMatrix& ccdata, const IntegerVector& ccstatus);
+RcppExport SEXP buRden_fisher_per_marker(SEXP ccdataSEXP, SEXP ccstatusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    __result = Rcpp::wrap(fisher_per_marker(ccdata, ccstatus));
+    return __result;
+END_RCPP
+}
+// simd_kernel
+std::string simd_kernel();
+RcppExport SEXP buRden_simd_kernel() {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    __result = Rcpp::wrap(simd_kernel());
+    return __result;
+END_RCPP
+}
 // esm
 double esm(const Rcpp::NumericVector& scores, const unsigned& K);
 RcppExport SEXP buRden_esm(SEXP scoresSEXP, SEXP KSEXP) {
@@ -121,21 +250,22 @@ BEGIN_RCPP
 END_RCPP
 }
 // esm_chisq
-double esm_chisq(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& k);
-RcppExport SEXP buRden_esm_chisq(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP kSEXP) {
+double esm_chisq(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& k, const bool& fisher);
+RcppExport SEXP buRden_esm_chisq(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP kSEXP, SEXP fisherSEXP) {
 BEGIN_RCPP
     Rcpp::RObject __result;
     Rcpp::RNGScope __rngScope;
     Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
     Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
     Rcpp::traits::input_parameter< const unsigned& >::type k(kSEXP);
-    __result = Rcpp::wrap(esm_chisq(ccdata, ccstatus, k));
+    Rcpp::traits::input_parameter< const bool& >::type fisher(fisherSEXP);
+    __result = Rcpp::wrap(esm_chisq(ccdata, ccstatus, k, fisher));
     return __result;
 END_RCPP
 }
 // esm_perm_binary
-NumericVector esm_perm_binary(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& k);
-RcppExport SEXP buRden_esm_perm_binary(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP kSEXP) {
+NumericVector esm_perm_binary(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& k, const bool& fisher);
+RcppExport SEXP buRden_esm_perm_binary(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP kSEXP, SEXP fisherSEXP) {
 BEGIN_RCPP
     Rcpp::RObject __result;
     Rcpp::RNGScope __rngScope;
@@ -143,7 +273,23 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
     Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
     Rcpp::traits::input_parameter< const unsigned& >::type k(kSEXP);
-    __result = Rcpp::wrap(esm_perm_binary(ccdata, ccstatus, nperms, k));
+    Rcpp::traits::input_parameter< const bool& >::type fisher(fisherSEXP);
+    __result = Rcpp::wrap(esm_perm_binary(ccdata, ccstatus, nperms, k, fisher));
+    return __result;
+END_RCPP
+}
+// esm_perm_plan
+NumericVector esm_perm_plan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, XPtr<perm_plan> plan, const unsigned& k, const bool& fisher);
+RcppExport SEXP buRden_esm_perm_plan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP planSEXP, SEXP kSEXP, SEXP fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type k(kSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type fisher(fisherSEXP);
+    __result = Rcpp::wrap(esm_perm_plan(ccdata, ccstatus, plan, k, fisher));
     return __result;
 END_RCPP
 }
@@ -162,6 +308,71 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// geneSetBurdenStats
+List geneSetBurdenStats(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const List& genes, const List& sets, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const unsigned& nperms, const unsigned& seed, const bool esm_fisher);
+RcppExport SEXP buRden_geneSetBurdenStats(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP genesSEXP, SEXP setsSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP npermsSEXP, SEXP seedSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const List& >::type genes(genesSEXP);
+    Rcpp::traits::input_parameter< const List& >::type sets(setsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(geneSetBurdenStats(ccdata, ccstatus, genes, sets, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, nperms, seed, esm_fisher));
+    return __result;
+END_RCPP
+}
+// allBurdenStatsPermAsync
+XPtr<perm_job> allBurdenStatsPermAsync(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& seed, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const unsigned& nthreads, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsPermAsync(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP seedSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP nthreadsSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsPermAsync(ccdata, ccstatus, nperms, seed, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, nthreads, esm_fisher));
+    return __result;
+END_RCPP
+}
+// permJobProgress
+List permJobProgress(XPtr<perm_job> job);
+RcppExport SEXP buRden_permJobProgress(SEXP jobSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< XPtr<perm_job> >::type job(jobSEXP);
+    __result = Rcpp::wrap(permJobProgress(job));
+    return __result;
+END_RCPP
+}
+// permJobCancel
+void permJobCancel(XPtr<perm_job> job, const bool& wait);
+RcppExport SEXP buRden_permJobCancel(SEXP jobSEXP, SEXP waitSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< XPtr<perm_job> >::type job(jobSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type wait(waitSEXP);
+    permJobCancel(job, wait);
+    return R_NilValue;
+END_RCPP
+}
 // MBweights
 NumericVector MBweights(const IntegerMatrix& ccdata, const IntegerVector& ccstatus);
 RcppExport SEXP buRden_MBweights(SEXP ccdataSEXP, SEXP ccstatusSEXP) {
@@ -199,6 +410,144 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// MB_perm_plan
+DataFrame MB_perm_plan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, XPtr<perm_plan> plan);
+RcppExport SEXP buRden_MB_perm_plan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP planSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    __result = Rcpp::wrap(MB_perm_plan(ccdata, ccstatus, plan));
+    return __result;
+END_RCPP
+}
+// permPlan
+XPtr<perm_plan> permPlan(const IntegerVector& ccstatus, const unsigned& nperms, const unsigned& seed, const std::string& file);
+RcppExport SEXP buRden_permPlan(SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP seedSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    __result = Rcpp::wrap(permPlan(ccstatus, nperms, seed, file));
+    return __result;
+END_RCPP
+}
+// permPlanOpen
+XPtr<perm_plan> permPlanOpen(const std::string& file);
+RcppExport SEXP buRden_permPlanOpen(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    __result = Rcpp::wrap(permPlanOpen(file));
+    return __result;
+END_RCPP
+}
+// permPlanWrite
+void permPlanWrite(XPtr<perm_plan> plan, const std::string& file);
+RcppExport SEXP buRden_permPlanWrite(SEXP planSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    permPlanWrite(plan, file);
+    return R_NilValue;
+END_RCPP
+}
+// permPlanInfo
+List permPlanInfo(XPtr<perm_plan> plan);
+RcppExport SEXP buRden_permPlanInfo(SEXP planSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    __result = Rcpp::wrap(permPlanInfo(plan));
+    return __result;
+END_RCPP
+}
+// permPlanLabels
+IntegerMatrix permPlanLabels(XPtr<perm_plan> plan, const unsigned& first, const unsigned& last);
+RcppExport SEXP buRden_permPlanLabels(SEXP planSEXP, SEXP firstSEXP, SEXP lastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type last(lastSEXP);
+    __result = Rcpp::wrap(permPlanLabels(plan, first, last));
+    return __result;
+END_RCPP
+}
+// allBurdenStatsPermPlan
+List allBurdenStatsPermPlan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, XPtr<perm_plan> plan, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const bool esm_fisher);
+RcppExport SEXP buRden_allBurdenStatsPermPlan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP planSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(allBurdenStatsPermPlan(ccdata, ccstatus, plan, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, esm_fisher));
+    return __result;
+END_RCPP
+}
+// write_packed_replicate
+void write_packed_replicate(const std::string& file, const IntegerMatrix& ccdata, const IntegerVector& ccstatus);
+RcppExport SEXP buRden_write_packed_replicate(SEXP fileSEXP, SEXP ccdataSEXP, SEXP ccstatusSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    write_packed_replicate(file, ccdata, ccstatus);
+    return R_NilValue;
+END_RCPP
+}
+// read_packed_replicate
+List read_packed_replicate(const std::string& file);
+RcppExport SEXP buRden_read_packed_replicate(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const std::string& >::type file(fileSEXP);
+    __result = Rcpp::wrap(read_packed_replicate(file));
+    return __result;
+END_RCPP
+}
+// powerStudy
+DataFrame powerStudy(SEXP source, const unsigned& nreps, const unsigned& nperms, const NumericVector& alpha, const unsigned& seed, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool& normalize_calpha, const bool& simplecount_calpha, const unsigned& nthreads, const bool& progress, const bool& esm_fisher);
+RcppExport SEXP buRden_powerStudy(SEXP sourceSEXP, SEXP nrepsSEXP, SEXP npermsSEXP, SEXP alphaSEXP, SEXP seedSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP nthreadsSEXP, SEXP progressSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< SEXP >::type source(sourceSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nreps(nrepsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nthreads(nthreadsSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(powerStudy(source, nreps, nperms, alpha, seed, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, nthreads, progress, esm_fisher));
+    return __result;
+END_RCPP
+}
 // ProductMoment
 std::iterator_traits<NumericVector::const_iterator>::value_type ProductMoment(const NumericVector& x, const NumericVector& y);
 RcppExport SEXP buRden_ProductMoment(SEXP xSEXP, SEXP ySEXP) {
@@ -211,6 +560,90 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// gpd_perm_p
+List gpd_perm_p(const NumericVector& permdist, const double& stat, const double& nperms, const unsigned& min_exceed, const unsigned& max_exceed, const unsigned& gof_reps, const double& gof_alpha, const unsigned& seed);
+RcppExport SEXP buRden_gpd_perm_p(SEXP permdistSEXP, SEXP statSEXP, SEXP npermsSEXP, SEXP min_exceedSEXP, SEXP max_exceedSEXP, SEXP gof_repsSEXP, SEXP gof_alphaSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const NumericVector& >::type permdist(permdistSEXP);
+    Rcpp::traits::input_parameter< const double& >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< const double& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type min_exceed(min_exceedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type max_exceed(max_exceedSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type gof_reps(gof_repsSEXP);
+    Rcpp::traits::input_parameter< const double& >::type gof_alpha(gof_alphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type seed(seedSEXP);
+    __result = Rcpp::wrap(gpd_perm_p(permdist, stat, nperms, min_exceed, max_exceed, gof_reps, gof_alpha, seed));
+    return __result;
+END_RCPP
+}
+// burden_minp
+List burden_minp(const NumericMatrix& permdist, const NumericVector& stat);
+RcppExport SEXP buRden_burden_minp(SEXP permdistSEXP, SEXP statSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const NumericMatrix& >::type permdist(permdistSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type stat(statSEXP);
+    __result = Rcpp::wrap(burden_minp(permdist, stat));
+    return __result;
+END_RCPP
+}
+// siteQC
+List siteQC(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const double& min_call_rate, const double& minfreq, const double& maxfreq, const double& hwe_p, const double& missing_p, const double& rsq_cutoff, const unsigned& nthreads);
+RcppExport SEXP buRden_siteQC(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP min_call_rateSEXP, SEXP minfreqSEXP, SEXP maxfreqSEXP, SEXP hwe_pSEXP, SEXP missing_pSEXP, SEXP rsq_cutoffSEXP, SEXP nthreadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const double& >::type min_call_rate(min_call_rateSEXP);
+    Rcpp::traits::input_parameter< const double& >::type minfreq(minfreqSEXP);
+    Rcpp::traits::input_parameter< const double& >::type maxfreq(maxfreqSEXP);
+    Rcpp::traits::input_parameter< const double& >::type hwe_p(hwe_pSEXP);
+    Rcpp::traits::input_parameter< const double& >::type missing_p(missing_pSEXP);
+    Rcpp::traits::input_parameter< const double& >::type rsq_cutoff(rsq_cutoffSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nthreads(nthreadsSEXP);
+    __result = Rcpp::wrap(siteQC(ccdata, ccstatus, min_call_rate, minfreq, maxfreq, hwe_p, missing_p, rsq_cutoff, nthreads));
+    return __result;
+END_RCPP
+}
+// burdenScan
+List burdenScan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const NumericVector& positions, const double& width, const double& step, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const unsigned& nperms, const bool esm_fisher);
+RcppExport SEXP buRden_burdenScan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP positionsSEXP, SEXP widthSEXP, SEXP stepSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP npermsSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type positions(positionsSEXP);
+    Rcpp::traits::input_parameter< const double& >::type width(widthSEXP);
+    Rcpp::traits::input_parameter< const double& >::type step(stepSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(burdenScan(ccdata, ccstatus, positions, width, step, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, nperms, esm_fisher));
+    return __result;
+END_RCPP
+}
+// skatTest
+List skatTest(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const NumericVector& weights);
+RcppExport SEXP buRden_skatTest(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP weightsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type weights(weightsSEXP);
+    __result = Rcpp::wrap(skatTest(ccdata, ccstatus, weights));
+    return __result;
+END_RCPP
+}
 // LLcollapse
 List LLcollapse(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const double& maf, const bool& maf_controls);
 RcppExport SEXP buRden_LLcollapse(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP mafSEXP, SEXP maf_controlsSEXP) {
@@ -240,3 +673,88 @@ BEGIN_RCPP
     return __result;
 END_RCPP
 }
+// LLcollapse_perm_plan
+NumericVector LLcollapse_perm_plan(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, XPtr<perm_plan> plan, const double& maf, const bool& maf_controls);
+RcppExport SEXP buRden_LLcollapse_perm_plan(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP planSEXP, SEXP mafSEXP, SEXP maf_controlsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< XPtr<perm_plan> >::type plan(planSEXP);
+    Rcpp::traits::input_parameter< const double& >::type maf(mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type maf_controls(maf_controlsSEXP);
+    __result = Rcpp::wrap(LLcollapse_perm_plan(ccdata, ccstatus, plan, maf, maf_controls));
+    return __result;
+END_RCPP
+}
+// burdenState
+RawVector burdenState(const IntegerMatrix& ccdata, const IntegerVector& ccstatus);
+RcppExport SEXP buRden_burdenState(SEXP ccdataSEXP, SEXP ccstatusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    __result = Rcpp::wrap(burdenState(ccdata, ccstatus));
+    return __result;
+END_RCPP
+}
+// burdenStateMerge
+RawVector burdenStateMerge(const RawVector& x, const RawVector& y);
+RcppExport SEXP buRden_burdenStateMerge(SEXP xSEXP, SEXP ySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const RawVector& >::type x(xSEXP);
+    Rcpp::traits::input_parameter< const RawVector& >::type y(ySEXP);
+    __result = Rcpp::wrap(burdenStateMerge(x, y));
+    return __result;
+END_RCPP
+}
+// burdenStateStats
+List burdenStateStats(const RawVector& state, const unsigned& esm_K, const double& LLc_maf, const bool& LLc_maf_control, const bool normalize_calpha, const bool simplecount_calpha, const bool esm_fisher);
+RcppExport SEXP buRden_burdenStateStats(SEXP stateSEXP, SEXP esm_KSEXP, SEXP LLc_mafSEXP, SEXP LLc_maf_controlSEXP, SEXP normalize_calphaSEXP, SEXP simplecount_calphaSEXP, SEXP esm_fisherSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const RawVector& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type esm_K(esm_KSEXP);
+    Rcpp::traits::input_parameter< const double& >::type LLc_maf(LLc_mafSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type LLc_maf_control(LLc_maf_controlSEXP);
+    Rcpp::traits::input_parameter< const bool >::type normalize_calpha(normalize_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type simplecount_calpha(simplecount_calphaSEXP);
+    Rcpp::traits::input_parameter< const bool >::type esm_fisher(esm_fisherSEXP);
+    __result = Rcpp::wrap(burdenStateStats(state, esm_K, LLc_maf, LLc_maf_control, normalize_calpha, simplecount_calpha, esm_fisher));
+    return __result;
+END_RCPP
+}
+// VTcollapse
+List VTcollapse(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const double& maf_max, const bool& maf_controls);
+RcppExport SEXP buRden_VTcollapse(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP maf_maxSEXP, SEXP maf_controlsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const double& >::type maf_max(maf_maxSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type maf_controls(maf_controlsSEXP);
+    __result = Rcpp::wrap(VTcollapse(ccdata, ccstatus, maf_max, maf_controls));
+    return __result;
+END_RCPP
+}
+// VTcollapse_perm
+NumericVector VTcollapse_perm(const IntegerMatrix& ccdata, const IntegerVector& ccstatus, const unsigned& nperms, const double& maf_max, const bool& maf_controls);
+RcppExport SEXP buRden_VTcollapse_perm(SEXP ccdataSEXP, SEXP ccstatusSEXP, SEXP npermsSEXP, SEXP maf_maxSEXP, SEXP maf_controlsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject __result;
+    Rcpp::RNGScope __rngScope;
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type ccdata(ccdataSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type ccstatus(ccstatusSEXP);
+    Rcpp::traits::input_parameter< const unsigned& >::type nperms(npermsSEXP);
+    Rcpp::traits::input_parameter< const double& >::type maf_max(maf_maxSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type maf_controls(maf_controlsSEXP);
+    __result = Rcpp::wrap(VTcollapse_perm(ccdata, ccstatus, nperms, maf_max, maf_controls));
+    return __result;
+END_RCPP
+}
@@ -0,0 +1,66 @@
+#include <stat_VT.hpp>
+#include <stat_calculator.hpp>
+#include <randWrapper.hpp>
+#include <algorithm>
+
+using namespace Rcpp;
+using namespace std;
+
+//' Variable-threshold version of Li and Leal's collapsed variant statistic
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param maf_max Only consider variants whose minor allele frequencies are <= maf_max
+//' @param maf_controls  If true, calculate mafs from controls only.  Otherwise, use all individuals
+//' @return A list.  thresholds contains every distinct MAF <= maf_max, in increasing order, and statistics contains the Li and Leal statistic
+//' calculated using each threshold as the MAF cutoff.  statistic is the largest of these, and threshold is the cutoff at which it occurs.
+//' @details statistics[i] is the same value as LLcollapse(ccdata,ccstatus,thresholds[i],maf_controls)$statistic, but the data are only read once.
+//' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
+//' @references Price, A. L., Kryukov, G. V., de Bakker, P. I. W., Purcell, S. M., Staples, J., Wei, L.-J., & Sunyaev, S. R. (2010). Pooled Association Tests for Rare Variants in Exon-Resequencing Studies. The American Journal of Human Genetics, 86(6), 832-838.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' VT = VTcollapse(rec.ccdata$genos,status,0.05)
+// [[Rcpp::export]]
+List VTcollapse(const IntegerMatrix & ccdata,
+		const IntegerVector & ccstatus,
+		const double & maf_max,
+		const bool & maf_controls = false)
+{
+  stat_VT f( maf_max, ccstatus, maf_controls );
+  return stat_calculator(ccdata,ccstatus,f);
+}
+
+//' Permutation distribution of the variable-threshold Li and Leal statistic
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param nperms The number of permutations to perform
+//' @param maf_max Only consider variants whose minor allele frequencies are <= maf_max
+//' @param maf_controls  If true, calculate mafs from controls only.  Otherwise, use all individuals
+//' @return The maximum statistic over all thresholds for each permutation
+//' @details The data are read once.  Each permutation only recounts carriers among cases, so the cost of a permutation does not depend
+//' on the number of markers.  When maf_controls is TRUE, the thresholds depend on the labels, and are re-calculated for each permutation.
+//' @references Price, A. L., Kryukov, G. V., de Bakker, P. I. W., Purcell, S. M., Staples, J., Wei, L.-J., & Sunyaev, S. R. (2010). Pooled Association Tests for Rare Variants in Exon-Resequencing Studies. The American Journal of Human Genetics, 86(6), 832-838.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' VT.perm = VTcollapse_perm(rec.ccdata$genos,status,10,0.05)
+// [[Rcpp::export]]
+NumericVector VTcollapse_perm(const IntegerMatrix & ccdata,
+			      const IntegerVector & ccstatus,
+			      const unsigned & nperms,
+			      const double & maf_max,
+			      const bool & maf_controls = false)
+{
+  NumericVector rv(nperms);
+  RNGScope scope;
+  IntegerVector status = clone(ccstatus);
+  stat_VT f( maf_max, ccstatus, maf_controls );
+  stat_calculator(ccdata,ccstatus,f);
+  for( unsigned i = 0 ; i < nperms ; ++i )
+    {
+      random_shuffle(status.begin(),status.end(),randWrapper);
+      rv[i] = f.max_statistic(status);
+      checkUserInterrupt();
+    }
+  return rv;
+}
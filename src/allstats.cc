@@ -1,12 +1,53 @@
 #include <Rcpp.h>
-#include <stat_allstats.hpp>
-#include <stat_calculator.hpp>
+#include <stat_multitrait.hpp>
+#include <sparse_genotypes.hpp>
+#include <site_patterns.hpp>
+#include <power_study.hpp>
+#include <validate.hpp>
 #include <randWrapper.hpp>
+#include <perm_summary.hpp>
 #include <algorithm>
+#include <string>
+#include <vector>
 
 using namespace Rcpp;
 using namespace std;
 
+/*
+  Every function here is a wrapper around stat_multitrait: the observed labels
+  are one trait, and permutations are scored POWER_PERM_BLOCK at a time, as
+  the traits of one pass over the genotypes.
+ */
+namespace {
+  //Elements of allBurdenStats' return value, in the order used by the shard summaries
+  const unsigned NSTATS = 6;
+  const char * SHARD_NAMES[NSTATS] = { "esm", "calpha", "MB.general", "MB.recessive", "MB.dominant", "LL.collapse" };
+
+  //The statistics of v, in the order of SHARD_NAMES
+  void stat_columns( const multitrait_values & v, const vector<double> * cols[NSTATS] )
+  {
+    cols[0] = &v.esm;
+    cols[1] = &v.calpha;
+    cols[2] = &v.MBg;
+    cols[3] = &v.MBr;
+    cols[4] = &v.MBd;
+    cols[5] = &v.LLc;
+  }
+
+  //Checks the arguments of the functions below, and returns the genotypes
+  sparse_genotypes checked_input( const IntegerMatrix & ccdata,
+				  const IntegerVector & ccstatus,
+				  const char * caller )
+  {
+    if( ccstatus.size() != ccdata.nrow() )
+      {
+	stop(string(caller) + ": length(ccstatus) != nrow(ccdata)");
+      }
+    validate_labels(ccstatus,caller);
+    return validate_genotypes(ccdata,caller);
+  }
+}
+
 //' Calculate all burden statistics simultaneously
 //' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
@@ -15,6 +56,7 @@ using namespace std;
 //' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
 //' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
 //' @param simplecount_calpha see Details
+//' @param esm_fisher If TRUE, ESM_K is calculated from Fisher's exact test for each marker (see fisher_per_marker) in place of the chi-squared test
 //' @return A list of values for all burden statistics
 //' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
 //' @references Neale, B. M., Rivas, M. A., Voight, B. F., Altshuler, D., Devlin, B., Orho-Melander, M., et al. (2011). Testing for an Unusual Distribution of Rare Variants. PLoS Genetics, 7(3), e1001322. doi:10.1371/journal.pgen.1001322
@@ -24,6 +66,21 @@ using namespace std;
 //' of the mutation.  In other wordes, simplecounts = FALSE is equivalent to colSums( ccdata[status==1,] ).  When simplecounts=TRUE,
 //' all nonzero genotype values are treated as the value 1, equivalent to  apply(data[status==1,], 2, function(x) sum(x>0, na.rm=TRUE)).
 //' The latter method is used by the R package AssotesteR.
+//'
+//' The Madsen-Browning weights use the number of cases in place of the number of controls, as they always have here, so a marker
+//' with more than 2*ncases+1 minor alleles in controls has no weight.  The Madsen-Browning statistics are then NaN, as they are for
+//' a window containing such a marker in burdenScan.  This is common when there are many more controls than cases.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' stats = allBurdenStats(rec.ccdata$genos[,which(keep==1)],status,50,5e-2)
+//' #3 cases and 27 controls, with 10 control and 1 case heterozygotes at the first marker
+//' g = matrix(0L,30,2)
+//' g[c(1:10,30),1] = 1L
+//' g[c(4,29),2] = c(1L,2L)
+//' unbalanced = allBurdenStats(g,c(rep(0,27),rep(1,3)),1,5e-2)
+//' stopifnot(is.nan(unbalanced$MB.general.stat),is.nan(unbalanced$MB.recessive.stat),is.nan(unbalanced$MB.dominant.stat))
 // [[Rcpp::export]]
 List allBurdenStats( const IntegerMatrix & ccdata,
 		     const IntegerVector & ccstatus,
@@ -31,10 +88,65 @@ List allBurdenStats( const IntegerMatrix & ccdata,
 		     const double & LLc_maf,
 		     const bool & LLc_maf_control = true,
 		     const bool normalize_calpha = false,
-		     const bool simplecount_calpha = false )
+		     const bool simplecount_calpha = false,
+		     const bool esm_fisher = false )
+{
+  const sparse_genotypes G = checked_input(ccdata,ccstatus,"allBurdenStats");
+  multitrait_values v;
+  stat_multitrait(ccstatus.begin(),ccstatus.size(),1)(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,v,0,esm_fisher);
+  return List::create( Named("esm.stat") = v.esm[0],
+		       Named("esm.K") = esm_K,
+		       Named("calpha.stat") = v.calpha[0],
+		       Named("MB.general.stat") = v.MBg[0],
+		       Named("MB.recessive.stat") = v.MBr[0],
+		       Named("MB.dominant.stat") = v.MBd[0],
+		       Named("LL.collapse.stat") = v.LLc[0] );
+}
+
+//' Calculate all burden statistics for many phenotypes at once
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param phenotypes A matrix of binary phenotype labels, with one row per individual and one column per trait.  0 = control, 1 = case.
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param esm_fisher see allBurdenStats.  The exact test's p-values are shared by all traits with the same number of cases.
+//' @return A data frame with one row per trait, whose columns are the values returned by allBurdenStats
+//' @details Row t is the same as allBurdenStats(ccdata,phenotypes[,t],...), but the genotypes are only read once for all traits.
+//' The traits are packed into bits, and the counts that each statistic needs are obtained for every trait from each site's carriers.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' phenos = cbind(status,sample(status),sample(status))
+//' all.traits = allBurdenStatsMulti(rec.ccdata$genos[,which(keep==1)],phenos,50,5e-2)
+// [[Rcpp::export]]
+DataFrame allBurdenStatsMulti( const IntegerMatrix & ccdata,
+			       const IntegerMatrix & phenotypes,
+			       const unsigned & esm_K,
+			       const double & LLc_maf,
+			       const bool & LLc_maf_control = true,
+			       const bool normalize_calpha = false,
+			       const bool simplecount_calpha = false,
+			       const bool esm_fisher = false )
 {
-  stat_allstats f(ccdata.nrow(),ccstatus,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha);
-  return stat_calculator(ccdata,ccstatus,f);
+  if( phenotypes.nrow() != ccdata.nrow() )
+    {
+      stop("allBurdenStatsMulti: nrow(phenotypes) != nrow(ccdata)");
+    }
+  validate_labels(phenotypes,"allBurdenStatsMulti");
+  const sparse_genotypes G = validate_genotypes(ccdata,"allBurdenStatsMulti");
+  stat_multitrait f(phenotypes.begin(),phenotypes.nrow(),phenotypes.ncol());
+  multitrait_values v;
+  f(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,v,0,esm_fisher);
+  return DataFrame::create( Named("esm.stat") = NumericVector(v.esm.begin(),v.esm.end()),
+			    Named("esm.K") = NumericVector(v.esm.size(),double(esm_K)),
+			    Named("calpha.stat") = NumericVector(v.calpha.begin(),v.calpha.end()),
+			    Named("MB.general.stat") = NumericVector(v.MBg.begin(),v.MBg.end()),
+			    Named("MB.recessive.stat") = NumericVector(v.MBr.begin(),v.MBr.end()),
+			    Named("MB.dominant.stat") = NumericVector(v.MBd.begin(),v.MBd.end()),
+			    Named("LL.collapse.stat") = NumericVector(v.LLc.begin(),v.LLc.end()) );
 }
 
 //' Estimate p-values for all burden statistics by permutation
@@ -46,6 +158,7 @@ List allBurdenStats( const IntegerMatrix & ccdata,
 //' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
 //' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
 //' @param simplecount_calpha see Details
+//' @param esm_fisher see allBurdenStats.  The exact test's p-values are calculated once for each block of permutations.
 //' @return A list of p-values for all burden statistics.
 //' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
 //' @references Neale, B. M., Rivas, M. A., Voight, B. F., Altshuler, D., Devlin, B., Orho-Melander, M., et al. (2011). Testing for an Unusual Distribution of Rare Variants. PLoS Genetics, 7(3), e1001322. doi:10.1371/journal.pgen.1001322
@@ -63,10 +176,14 @@ List allBurdenStatsPerm( const IntegerMatrix & ccdata,
 			 const double & LLc_maf,
 			 const bool & LLc_maf_control = true,
 			 const bool normalize_calpha = false,
-			 const bool simplecount_calpha = false )
+			 const bool simplecount_calpha = false,
+			 const bool esm_fisher = false )
 {
+  const sparse_genotypes G = checked_input(ccdata,ccstatus,"allBurdenStatsPerm");
+  const site_patterns patterns(G);
   RNGScope scope;
   IntegerVector status = clone(ccstatus);
+  const unsigned n = ccdata.nrow();
   //store permutation distributions
   NumericVector esm_p(nperms),
     calpha_p(nperms),
@@ -74,18 +191,28 @@ List allBurdenStatsPerm( const IntegerMatrix & ccdata,
     MBr_p(nperms),
     MBd_p(nperms),
     LLc_p(nperms);
+  NumericVector * permdists[NSTATS] = { &esm_p, &calpha_p, &MBg_p, &MBr_p, &MBd_p, &LLc_p };
 
-  for( unsigned i = 0 ; i < nperms; ++i )
+  //Each permutation shuffles the previous one with R's random number generator, as always, and a block of them is scored at once
+  vector<int> labels;
+  multitrait_values perm;
+  const vector<double> * cols[NSTATS];
+  for( unsigned first = 0 ; first < nperms ; first += POWER_PERM_BLOCK )
     {
-      random_shuffle(status.begin(),status.end(),randWrapper); 
-      stat_allstats f(ccdata.nrow(),status,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha);
-      List perm_vals = stat_calculator(ccdata,status,f);
-      esm_p[i] = as<double>( perm_vals["esm.stat"] );
-      calpha_p[i] = as<double>( perm_vals["calpha.stat"] );
-      MBg_p[i] = as<double>( perm_vals["MB.general.stat"] );
-      MBr_p[i] = as<double>( perm_vals["MB.recessive.stat"] );
-      MBd_p[i] = as<double>( perm_vals["MB.dominant.stat"] );
-      LLc_p[i] = as<double>( perm_vals["LL.collapse.stat"] );
+      const unsigned B = min(POWER_PERM_BLOCK,nperms-first);
+      labels.resize(size_t(n)*B);
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  random_shuffle(status.begin(),status.end(),randWrapper);
+	  copy(status.begin(),status.end(),labels.begin()+size_t(b)*n);
+	}
+      stat_multitrait(&labels[0],n,B)(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,perm,&patterns,esm_fisher);
+      stat_columns(perm,cols);
+      for( unsigned j = 0 ; j < NSTATS ; ++j )
+	{
+	  copy(cols[j]->begin(),cols[j]->end(),permdists[j]->begin()+first);
+	}
+      checkUserInterrupt();
     }
   return List::create( Named("esm.permdist") = esm_p,
 		       Named("calpha.permdist") = calpha_p,
@@ -95,3 +222,172 @@ List allBurdenStatsPerm( const IntegerMatrix & ccdata,
 		       Named("LL.collapse.permdist") = LLc_p
 		       );
 }
+
+//' Run a range of the permutations of a reproducible permutation test of all burden statistics
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param first The first permutation to run, counting from 1
+//' @param last The last permutation to run.  If last < first, no permutations are run.
+//' @param seed Random number seed
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param tail_size For each statistic, keep this many of the largest permuted values.
+//' @param esm_fisher see allBurdenStats
+//' @return A list summarizing permutations first through last, with the same elements as allBurdenStatsPermShard, except for nperms, nshards, and shard.
+//' @details Permutation i is the same as permutation i of allBurdenStatsPermShard with the same seed.  A run of n permutations may therefore be
+//' extended to m > n permutations by running permutations n+1 through m, which is what allBurdenStats.p.perm.cached does.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' more = allBurdenStatsPermRange(rec.ccdata$genos[,which(keep==1)],status,21,40,101,50,5e-2)
+// [[Rcpp::export]]
+List allBurdenStatsPermRange( const IntegerMatrix & ccdata,
+			      const IntegerVector & ccstatus,
+			      const unsigned & first,
+			      const unsigned & last,
+			      const unsigned & seed,
+			      const unsigned & esm_K,
+			      const double & LLc_maf,
+			      const bool & LLc_maf_control = true,
+			      const bool normalize_calpha = false,
+			      const bool simplecount_calpha = false,
+			      const unsigned & tail_size = 0,
+			      const bool esm_fisher = false )
+{
+  if( first < 1 )
+    {
+      stop("allBurdenStatsPermRange: permutations are counted from 1");
+    }
+  const sparse_genotypes G = checked_input(ccdata,ccstatus,"allBurdenStatsPermRange");
+  const site_patterns patterns(G);
+  const unsigned n = ccdata.nrow();
+  power_params par;
+  par.nperms = 0;
+  par.esm_K = esm_K;
+  par.LLc_maf = LLc_maf;
+  par.LLc_maf_control = LLc_maf_control;
+  par.normalize_calpha = normalize_calpha;
+  par.simplecount_calpha = simplecount_calpha;
+  par.esm_fisher = esm_fisher;
+  par.seed = seed;
+  const vector<int> status(ccstatus.begin(),ccstatus.end());
+  multitrait_values v;
+  const vector<double> * cols[NSTATS];
+  stat_multitrait(ccstatus.begin(),n,1)(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,v,&patterns,esm_fisher);
+  stat_columns(v,cols);
+  vector<perm_summary> summaries;
+  for( unsigned j = 0 ; j < NSTATS ; ++j )
+    {
+      summaries.push_back( perm_summary( (*cols[j])[0], tail_size ) );
+    }
+
+  //Permutation i uses stream i-1, which is permutation i-1 of replicate 0 for burden_perm_values
+  vector<int> labels;
+  for( unsigned i = first - 1 ; i < last ; i += POWER_PERM_BLOCK )
+    {
+      const unsigned B = min(POWER_PERM_BLOCK,last-i);
+      burden_perm_values(G,&status[0],0,i,B,par,v,labels,&patterns);
+      stat_columns(v,cols);
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  for( unsigned j = 0 ; j < NSTATS ; ++j )
+	    {
+	      summaries[j]( (*cols[j])[b] );
+	    }
+	}
+      checkUserInterrupt();
+    }
+
+  NumericVector stat(NSTATS),nexceed(NSTATS),sum(NSTATS),sumsq(NSTATS);
+  List tails(NSTATS);
+  for( unsigned j = 0 ; j < NSTATS ; ++j )
+    {
+      stat[j] = summaries[j].observed;
+      nexceed[j] = summaries[j].nexceed;
+      sum[j] = summaries[j].sum;
+      sumsq[j] = summaries[j].sumsq;
+      vector<double> t = summaries[j].tail_values();
+      tails[j] = NumericVector(t.begin(),t.end());
+    }
+  CharacterVector names(SHARD_NAMES,SHARD_NAMES+NSTATS);
+  stat.names() = names;
+  nexceed.names() = names;
+  sum.names() = names;
+  sumsq.names() = names;
+  tails.names() = names;
+  return List::create( Named("seed") = seed,
+		       Named("first") = first,
+		       Named("last") = last,
+		       Named("params") = NumericVector::create(esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,tail_size,esm_fisher),
+		       Named("statistic") = stat,
+		       Named("nexceed") = nexceed,
+		       Named("sum") = sum,
+		       Named("sumsq") = sumsq,
+		       Named("tail") = tails );
+}
+
+//' Run one shard of a reproducible permutation test of all burden statistics
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param nperms Total number of permutations, summed over all shards
+//' @param nshards The number of shards that the permutations are divided into
+//' @param shard Which shard to run, from 1 to nshards
+//' @param seed Random number seed.  Every shard of a run must use the same seed.
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param tail_size For each statistic, keep this many of the largest permuted values.
+//' @param esm_fisher see allBurdenStats
+//' @return A list summarizing the shard: the observed statistics, and the number of permutations, the number of permuted values >= the observed value, the sum and sum of squares of the permuted values, and the retained tail, for each statistic.
+//' @details Permutation i (from 1 to nperms) is generated by its own random number stream, which is determined by seed and i.  Shard s performs
+//' permutations floor((s-1)*nperms/nshards)+1 through floor(s*nperms/nshards).  The permutations are therefore the same no matter how they are
+//' divided among shards, and R's random number generator is not used.  Use merge_perm_shards to combine the shards.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' shard1 = allBurdenStatsPermShard(rec.ccdata$genos[,which(keep==1)],status,20,2,1,101,50,5e-2)
+//' shard2 = allBurdenStatsPermShard(rec.ccdata$genos[,which(keep==1)],status,20,2,2,101,50,5e-2)
+//' all.p = merge_perm_shards( list(shard1,shard2) )
+// [[Rcpp::export]]
+List allBurdenStatsPermShard( const IntegerMatrix & ccdata,
+			      const IntegerVector & ccstatus,
+			      const unsigned & nperms,
+			      const unsigned & nshards,
+			      const unsigned & shard,
+			      const unsigned & seed,
+			      const unsigned & esm_K,
+			      const double & LLc_maf,
+			      const bool & LLc_maf_control = true,
+			      const bool normalize_calpha = false,
+			      const bool simplecount_calpha = false,
+			      const unsigned & tail_size = 0,
+			      const bool esm_fisher = false )
+{
+  if( nshards == 0 || shard < 1 || shard > nshards )
+    {
+      stop("allBurdenStatsPermShard: shard must be between 1 and nshards");
+    }
+  //This shard's slice of the permutation indexes [0,nperms)
+  const unsigned first = unsigned( (uint64_t(shard-1)*uint64_t(nperms))/uint64_t(nshards) ),
+    last = unsigned( (uint64_t(shard)*uint64_t(nperms))/uint64_t(nshards) );
+  List r = allBurdenStatsPermRange(ccdata,ccstatus,first+1,last,seed,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,tail_size,esm_fisher);
+  return List::create( Named("seed") = seed,
+		       Named("nperms") = nperms,
+		       Named("nshards") = nshards,
+		       Named("shard") = shard,
+		       Named("first") = first + 1,
+		       Named("last") = last,
+		       Named("params") = r["params"],
+		       Named("statistic") = r["statistic"],
+		       Named("nexceed") = r["nexceed"],
+		       Named("sum") = r["sum"],
+		       Named("sumsq") = r["sumsq"],
+		       Named("tail") = r["tail"] );
+}
@@ -0,0 +1,8 @@
+#ifndef __BURDEN_TYPES_H__
+#define __BURDEN_TYPES_H__
+
+//Types that appear in the signatures of exported functions, for RcppExports.cpp
+#include <perm_job.hpp>
+#include <perm_plan.hpp>
+
+#endif
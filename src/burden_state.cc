@@ -0,0 +1,328 @@
+#include <burden_state.hpp>
+#include <cAlpha_variance.hpp>
+#include <mb_scores.hpp>
+#include <chisq.hpp>
+#include <esm_stat.hpp>
+#include <fisher_exact.hpp>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdint.h>
+
+using namespace std;
+
+namespace {
+  /*
+    Serialized layout, with unsigned 32-bit integers stored least significant byte first:
+    "BRST", format version (2), number of individuals, number of sites, number of carried sites
+    (64 bits, as its low and then its high 32 bits; version 1 had only 32 bits), one byte of status per individual, the number of sites carried by each individual,
+    the carried sites, one byte of genotype per carried site, and then the dosage,
+    case_dosage, carriers, and case_carriers of every site.
+  */
+  const unsigned char MAGIC[4] = { 'B','R','S','T' };
+  const uint32_t VERSION = 2;
+
+  void put_u32( vector<unsigned char> & b, const uint32_t & x )
+  {
+    b.push_back( (unsigned char)(x & 0xFF) );
+    b.push_back( (unsigned char)((x>>8) & 0xFF) );
+    b.push_back( (unsigned char)((x>>16) & 0xFF) );
+    b.push_back( (unsigned char)((x>>24) & 0xFF) );
+  }
+
+  bool get_u32( const unsigned char * & b, const unsigned char * end, uint32_t & x )
+  {
+    if( end - b < 4 ) return false;
+    x = uint32_t(b[0]) | (uint32_t(b[1])<<8) | (uint32_t(b[2])<<16) | (uint32_t(b[3])<<24);
+    b += 4;
+    return true;
+  }
+
+  //Recalculate the per-site counts from the carried sites
+  void site_counts( const burden_state & s,
+		    vector<unsigned> & dosage,
+		    vector<unsigned> & case_dosage,
+		    vector<unsigned> & carriers,
+		    vector<unsigned> & case_carriers )
+  {
+    dosage.assign(s.nsites,0);
+    case_dosage.assign(s.nsites,0);
+    carriers.assign(s.nsites,0);
+    case_carriers.assign(s.nsites,0);
+    for( unsigned i = 0 ; i < s.nrow() ; ++i )
+      {
+	for( size_t k = s.rowptr[i] ; k < s.rowptr[i+1] ; ++k )
+	  {
+	    const unsigned j = s.site[k], g = s.geno[k];
+	    dosage[j] += g;
+	    ++carriers[j];
+	    if( s.status[i] )
+	      {
+		case_dosage[j] += g;
+		++case_carriers[j];
+	      }
+	  }
+      }
+  }
+}
+
+burden_state::burden_state( const unsigned & __nsites ) : nsites(__nsites),
+							  status(vector<char>()),
+							  rowptr(vector<size_t>(1,0)),
+							  site(vector<unsigned>()),
+							  geno(vector<char>()),
+							  dosage(vector<unsigned>(__nsites,0)),
+							  case_dosage(vector<unsigned>(__nsites,0)),
+							  carriers(vector<unsigned>(__nsites,0)),
+							  case_carriers(vector<unsigned>(__nsites,0))
+{
+}
+
+unsigned burden_state::nrow() const
+{
+  return status.size();
+}
+
+unsigned burden_state::ncases() const
+{
+  return count(status.begin(),status.end(),1);
+}
+
+bool burden_state::add_rows( const int * genos, const unsigned & nrow, const int * labels, string & error )
+{
+  for( unsigned i = 0 ; i < nrow ; ++i )
+    {
+      if( labels[i] != 0 && labels[i] != 1 )
+	{
+	  error = "phenotype label other than 0 or 1 encountered";
+	  return false;
+	}
+    }
+  //count each new row's carried sites, then fill them in site order
+  vector<unsigned> nc(nrow,0);
+  const int * g = genos;
+  for( unsigned j = 0 ; j < nsites ; ++j )
+    {
+      for( unsigned i = 0 ; i < nrow ; ++i, ++g )
+	{
+	  if( *g < 0 || *g > 2 )
+	    {
+	      error = "genotype value other than 0, 1, or 2 encountered";
+	      return false;
+	    }
+	  if( *g ) ++nc[i];
+	}
+    }
+  const unsigned n0 = status.size();
+  vector<size_t> next(nrow);
+  for( unsigned i = 0 ; i < nrow ; ++i )
+    {
+      next[i] = rowptr.back();
+      rowptr.push_back( rowptr.back() + nc[i] );
+      status.push_back( char(labels[i]) );
+    }
+  site.resize(rowptr.back());
+  geno.resize(rowptr.back());
+  g = genos;
+  for( unsigned j = 0 ; j < nsites ; ++j )
+    {
+      for( unsigned i = 0 ; i < nrow ; ++i, ++g )
+	{
+	  if( *g )
+	    {
+	      site[next[i]] = j;
+	      geno[next[i]++] = char(*g);
+	      dosage[j] += *g;
+	      ++carriers[j];
+	      if( status[n0+i] )
+		{
+		  case_dosage[j] += *g;
+		  ++case_carriers[j];
+		}
+	    }
+	}
+    }
+  return true;
+}
+
+bool burden_state::merge( const burden_state & other, string & error )
+{
+  if( other.nsites != nsites )
+    {
+      error = "states have different numbers of sites";
+      return false;
+    }
+  const size_t offset = rowptr.back();
+  for( unsigned i = 0 ; i < other.nrow() ; ++i )
+    {
+      rowptr.push_back( offset + other.rowptr[i+1] );
+    }
+  status.insert(status.end(),other.status.begin(),other.status.end());
+  site.insert(site.end(),other.site.begin(),other.site.end());
+  geno.insert(geno.end(),other.geno.begin(),other.geno.end());
+  for( unsigned j = 0 ; j < nsites ; ++j )
+    {
+      dosage[j] += other.dosage[j];
+      case_dosage[j] += other.case_dosage[j];
+      carriers[j] += other.carriers[j];
+      case_carriers[j] += other.case_carriers[j];
+    }
+  return true;
+}
+
+void burden_state::serialize( vector<unsigned char> & buffer ) const
+{
+  buffer.clear();
+  buffer.reserve( 24 + 5*size_t(nrow()) + 5*site.size() + 16*size_t(nsites) );
+  buffer.insert(buffer.end(),MAGIC,MAGIC+4);
+  put_u32(buffer,VERSION);
+  put_u32(buffer,nrow());
+  put_u32(buffer,nsites);
+  const uint64_t nnz = site.size();
+  put_u32(buffer,uint32_t(nnz & 0xFFFFFFFF));
+  put_u32(buffer,uint32_t(nnz >> 32));
+  buffer.insert(buffer.end(),status.begin(),status.end());
+  for( unsigned i = 0 ; i < nrow() ; ++i ) put_u32(buffer,rowptr[i+1]-rowptr[i]);
+  for( vector<unsigned>::const_iterator itr = site.begin() ; itr != site.end() ; ++itr ) put_u32(buffer,*itr);
+  buffer.insert(buffer.end(),geno.begin(),geno.end());
+  const vector<unsigned> * counts[4] = { &dosage, &case_dosage, &carriers, &case_carriers };
+  for( unsigned c = 0 ; c < 4 ; ++c )
+    {
+      for( vector<unsigned>::const_iterator itr = counts[c]->begin() ; itr != counts[c]->end() ; ++itr ) put_u32(buffer,*itr);
+    }
+}
+
+bool burden_state::deserialize( const unsigned char * buffer, const size_t & len, string & error )
+{
+  const unsigned char * b = buffer, * end = buffer + len;
+  uint32_t version,nr,ns,nnz_lo,nnz_hi = 0;
+  if( len < 4 || !equal(b,b+4,MAGIC) )
+    {
+      error = "not a serialized burden state";
+      return false;
+    }
+  b += 4;
+  if( !get_u32(b,end,version) || !get_u32(b,end,nr) || !get_u32(b,end,ns) || !get_u32(b,end,nnz_lo) ||
+      ( version > 1 && !get_u32(b,end,nnz_hi) ) )
+    {
+      error = "serialized burden state is truncated";
+      return false;
+    }
+  if( version < 1 || version > VERSION )
+    {
+      error = "serialized burden state has an unsupported format version";
+      return false;
+    }
+  const uint64_t nnz = uint64_t(nnz_lo) | (uint64_t(nnz_hi) << 32);
+  //every remaining field has a known size
+  if( size_t(end-b) != size_t(nr)*5 + size_t(nnz)*5 + size_t(ns)*16 )
+    {
+      error = "serialized burden state is truncated or has trailing data";
+      return false;
+    }
+  burden_state s(ns);
+  s.status.assign(b,b+nr);
+  b += nr;
+  s.rowptr.resize(size_t(nr)+1);
+  for( unsigned i = 0 ; i < nr ; ++i )
+    {
+      uint32_t k = 0;
+      get_u32(b,end,k);
+      s.rowptr[i+1] = s.rowptr[i] + k;
+    }
+  s.site.resize(nnz);
+  for( size_t k = 0 ; k < nnz ; ++k ) get_u32(b,end,s.site[k]);
+  s.geno.assign(b,b+nnz);
+  b += nnz;
+  vector<unsigned> * counts[4] = { &s.dosage, &s.case_dosage, &s.carriers, &s.case_carriers };
+  for( unsigned c = 0 ; c < 4 ; ++c )
+    {
+      for( unsigned j = 0 ; j < ns ; ++j ) get_u32(b,end,(*counts[c])[j]);
+    }
+
+  //check the structure, then that the stored counts agree with the carried sites
+  bool ok = ( s.rowptr.back() == nnz );
+  for( unsigned i = 0 ; ok && i < nr ; ++i )
+    {
+      ok = ( s.status[i] == 0 || s.status[i] == 1 );
+      for( size_t k = s.rowptr[i] ; ok && k < s.rowptr[i+1] ; ++k )
+	{
+	  ok = ( s.site[k] < ns && s.geno[k] >= 1 && s.geno[k] <= 2 && ( k == s.rowptr[i] || s.site[k] > s.site[k-1] ) );
+	}
+    }
+  if( ok )
+    {
+      vector<unsigned> d,cd,c,cc;
+      site_counts(s,d,cd,c,cc);
+      ok = ( d == s.dosage && cd == s.case_dosage && c == s.carriers && cc == s.case_carriers );
+    }
+  if( !ok )
+    {
+      error = "serialized burden state is corrupt";
+      return false;
+    }
+  swap(*this,s);
+  return true;
+}
+
+void burden_state_stats( const burden_state & state,
+			 const unsigned & esm_K,
+			 const double & LLc_maf,
+			 const bool & LLc_maf_control,
+			 const bool & normalize_calpha,
+			 const bool & simplecount_calpha,
+			 vector<double> & rv,
+			 const bool & esm_fisher )
+{
+  const unsigned n = state.nrow(), m = state.nsites, ncases = state.ncases(), ncontrols = n - ncases;
+  const double p0 = double(ncases)/double(n);
+  fisher_exact fisher( (esm_fisher) ? 2*n : 0, 2*ncases );
+
+  //ESM and c-alpha need only the per-site counts
+  vector<double> log10p(m),wi(m);
+  vector<char> rare(m);
+  double T = 0.;
+  map<unsigned,unsigned> ns;
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      const unsigned control_minor = state.dosage[j] - state.case_dosage[j];
+      log10p[j] = (esm_fisher) ? fisher.log10p( state.dosage[j], state.case_dosage[j] )
+	: chisq_log10p( control_minor, 2*ncontrols - control_minor, state.case_dosage[j], 2*ncases - state.case_dosage[j] );
+      const unsigned n_i = (simplecount_calpha) ? state.carriers[j] : state.dosage[j],
+	y_i = (simplecount_calpha) ? state.case_carriers[j] : state.case_dosage[j];
+      T += ( pow( double(y_i)-double(n_i)*p0, 2.) - double(n_i)*p0*(1.-p0) );
+      if( normalize_calpha ) ++ns[n_i];
+      //number of cases in place of the number of controls, as allBurdenStats always has
+      wi[j] = mb_weight(control_minor,ncases,n);
+      rare[j] = (LLc_maf_control) ? ( double(control_minor)/double(2*ncontrols) <= LLc_maf ) : ( double(state.dosage[j])/double(2*n) <= LLc_maf );
+    }
+
+  //Madsen-Browning scores and Li-Leal indicators are rebuilt from each individual's carried sites
+  mb_rank_engine ranker;
+  unsigned co = 0, ca = 0;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      if( state.rowptr[i] == state.rowptr[i+1] ) continue;
+      double sg = 0., sr = 0., sd = 0.;
+      bool has_rare = false;
+      for( size_t k = state.rowptr[i] ; k < state.rowptr[i+1] ; ++k )
+	{
+	  const unsigned j = state.site[k];
+	  sg += double(state.geno[k])/wi[j];
+	  sd += 1./wi[j];
+	  if( state.geno[k] == 2 ) sr += 1./wi[j];
+	  has_rare = has_rare || rare[j];
+	}
+      ranker.push_back(sg,sr,sd,state.status[i] == 1);
+      if( has_rare )
+	{
+	  if( state.status[i] ) ++ca;
+	  else ++co;
+	}
+    }
+  rv.resize(6);
+  rv[0] = esm_stat(log10p,esm_K);
+  rv[1] = (normalize_calpha) ? T/sqrt(cAlpha_Z(ns,p0)) : T;
+  ranker(n,ncases,rv[2],rv[3],rv[4]);
+  rv[5] = chisq(co,ncontrols-co,ca,ncases-ca);
+}
@@ -0,0 +1,67 @@
+#ifndef __BURDEN_STATE_HPP__
+#define __BURDEN_STATE_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+  Sufficient statistics of a case/control sample, which can be built on row
+  shards (subsets of individuals) and merged.
+
+  For each site, the allele and carrier counts in all individuals and in cases
+  are kept.  These are additive over individuals, so merging two states adds
+  them, and the ESM and c-alpha statistics of the merged sample follow from the
+  counts alone.
+
+  Madsen-Browning weights and Li-Leal "rare" sites depend on allele counts in the
+  whole sample, so they change when individuals are added.  For those, each
+  individual's carried sites (site and genotype, in increasing order of site) are
+  kept, and the scores, ranks, and collapsed indicators are rebuilt from them by
+  burden_state_stats, at a cost of O(carriers) rather than O(individuals x sites).
+
+  Adding a batch of individuals therefore only reads the new rows.  Results equal
+  those of allBurdenStats on the combined data, with individuals in the order in
+  which they were added.
+
+  Functions returning bool describe the problem in error if they fail.
+  No R objects are used.
+ */
+class burden_state
+{
+public:
+  unsigned nsites;
+  //0 = control, 1 = case, one per individual
+  std::vector<char> status;
+  //sites carried by individual i are site[rowptr[i]] through site[rowptr[i+1]-1]
+  std::vector<size_t> rowptr;
+  std::vector<unsigned> site;
+  std::vector<char> geno;
+  //per-site counts: minor alleles and carriers, in everyone and in cases
+  std::vector<unsigned> dosage,case_dosage,carriers,case_carriers;
+  burden_state( const unsigned & __nsites = 0 );
+  unsigned nrow() const;
+  unsigned ncases() const;
+  //Add nrow individuals.  genos is nrow x nsites and column-major.
+  bool add_rows( const int * genos, const unsigned & nrow, const int * labels, std::string & error );
+  //Append the individuals of another state with the same sites
+  bool merge( const burden_state & other, std::string & error );
+  void serialize( std::vector<unsigned char> & buffer ) const;
+  bool deserialize( const unsigned char * buffer, const size_t & len, std::string & error );
+};
+
+/*
+  The statistics of allBurdenStats (esm, c-alpha, MB general, recessive, and
+  dominant, and Li-Leal), in that order.  If esm_fisher is true, ESM uses
+  Fisher's exact test of each site in place of the chi-squared.
+ */
+void burden_state_stats( const burden_state & state,
+			 const unsigned & esm_K,
+			 const double & LLc_maf,
+			 const bool & LLc_maf_control,
+			 const bool & normalize_calpha,
+			 const bool & simplecount_calpha,
+			 std::vector<double> & rv,
+			 const bool & esm_fisher = false );
+
+#endif
@@ -2,6 +2,7 @@
 #include <stat_cAlpha.hpp>
 #include <stat_calculator.hpp>
 #include <randWrapper.hpp>
+#include <validate.hpp>
 #include <algorithm>
 #include <map>
 
@@ -14,6 +15,7 @@ using namespace std;
 //' @param normalize Return the statistic divided by the square root of its variance.
 //' @param simplecounts See Details.
 //' @return The c-alpha test statistic.  If normalize = TRUE, then T/sqrt(Z) is returned, otherwise T is returned.
+//' @seealso cAlpha_test for a p-value that does not require permutations
 //' @details  When simplecounts = FALSE, heterozygous and homozygous genotypes are treated as different numbers of observations
 //' of the mutation.  In other wordes, simplecounts = FALSE is equivalent to colSums( ccdata[status==1,] ).  When simplecounts=TRUE,
 //' all nonzero genotype values are treated as the value 1, equivalent to  apply(data[status==1,], 2, function(x) sum(x>0, na.rm=TRUE)).
@@ -66,7 +68,72 @@ NumericVector cAlpha_perm( const IntegerMatrix & ccdata,
     {
       RNGScope scope;
       random_shuffle(cc.begin(),cc.end(),randWrapper);
-      rv[i]=cAlpha(ccdata,cc);
+      rv[i]=cAlpha(ccdata,cc,false,simplecounts);
+      checkUserInterrupt();
     }
   return rv;
 }
+
+//' Permutation distribution of the c-alpha statistic from a permutation plan
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param simplecounts See Details of cAlpha_perm.
+//' @return The distribution of the test statistic, the same as cAlpha_perm, with one value per permutation of the plan.
+//' @details ccstatus is only used to check that the plan has the same numbers of individuals and cases.  The labels of each permutation
+//' are read from the plan as they are needed.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases) )
+//' rec.ccdata.MAFS = colSums( rec.ccdata$genos[which(status==0),] )/(2*rec.ccdata$ncontrols)
+//' plan = permPlan(status,100,101)
+//' rec.ccdata.calpha.permdist = cAlpha_perm_plan(rec.ccdata$genos[,which(rec.ccdata.MAFS <= 0.05)],status,plan)
+// [[Rcpp::export]]
+NumericVector cAlpha_perm_plan( const IntegerMatrix & ccdata,
+				const IntegerVector & ccstatus,
+				XPtr<perm_plan> plan,
+				const bool & simplecounts = false )
+{
+  const perm_plan * p = validate_plan(plan,ccstatus,"cAlpha_perm_plan");
+  NumericVector rv(p->nperms);
+  IntegerVector cc(p->n);
+
+  for( unsigned i = 0 ; i < p->nperms ; ++i )
+    {
+      p->labels(i,cc.begin());
+      rv[i]=cAlpha(ccdata,cc,false,simplecounts);
+      checkUserInterrupt();
+    }
+  return rv;
+}
+
+//' The c-alpha test, with an asymptotic p-value
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param simplecounts See Details of cAlpha.
+//' @return A list with the c-alpha statistic T (statistic), its variance Z under the null (variance), the normalized statistic T/sqrt(Z) (z),
+//' and the p-value P(N(0,1) >= z) (p.value).
+//' @details T/sqrt(Z) is asymptotically standard normal under the null hypothesis, and a large value of T means an excess of variants
+//' that are enriched in cases or in controls, so the test is one-sided (Neale et al. 2011).  Z is calculated from the closed-form central moments
+//' of the binomial distribution, at a constant cost for each distinct number of observations of a variant.
+//' The normal approximation may be poor when there are few variants or few observations of each.  In that case, the p-value may
+//' be checked by permutation (see calpha.p.perm).
+//' @references Neale, B. M., Rivas, M. A., Voight, B. F., Altshuler, D., Devlin, B., Orho-Melander, M., et al. (2011). Testing for an Unusual Distribution of Rare Variants. PLoS Genetics, 7(3), e1001322. doi:10.1371/journal.pgen.1001322
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases) )
+//' rec.ccdata.MAFS = colSums( rec.ccdata$genos[which(status==0),] )/(2*rec.ccdata$ncontrols)
+//' rec.ccdata.calpha.test = cAlpha_test(rec.ccdata$genos[,which(rec.ccdata.MAFS <= 0.05)],status)
+// [[Rcpp::export]]
+List cAlpha_test( const IntegerMatrix & ccdata,
+		  const IntegerVector & ccstatus,
+		  const bool & simplecounts = false )
+{
+  stat_cAlpha f(ccstatus,true,simplecounts);
+  List rv = stat_calculator(ccdata,ccstatus,f);
+  const double z = as<double>(rv["statistic"]);
+  return List::create( Named("statistic") = rv["T"],
+		       Named("variance") = rv["variance"],
+		       Named("z") = z,
+		       Named("p.value") = R::pnorm(z,0.,1.,0,0) );
+}
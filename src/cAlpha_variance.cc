@@ -0,0 +1,2 @@
+//The implementation is in inst/include/buRden/impl, so that it may also be used header-only
+#include <impl/cAlpha_variance.ipp>
@@ -0,0 +1,51 @@
+#include <Rcpp.h>
+#include <content_hash.hpp>
+#include <string>
+
+using namespace Rcpp;
+using namespace std;
+
+namespace {
+  //Changing how keys are built must change this, so that old entries are never matched
+  const unsigned CACHE_KEY_VERSION = 1;
+}
+
+//' Key under which a burden test result is cached
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param what The kind of result, usually the name of the function that calculates it
+//' @param params The parameters of the calculation, such as K, MAF cutoffs, flags, and random number seeds
+//' @return A string of 32 hexadecimal digits
+//' @details The key is a 128-bit hash of the dimensions and contents of ccdata, of ccstatus, of what, and of params.
+//' It does not depend on the platform, so a cache directory may be shared between machines.  See burden.cache.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' key = burden_cache_key(rec.ccdata$genos,status,"allBurdenStats",c(50,0.05,1,0,0))
+// [[Rcpp::export]]
+std::string burden_cache_key( const IntegerMatrix & ccdata,
+			      const IntegerVector & ccstatus,
+			      const std::string & what,
+			      const NumericVector & params )
+{
+  content_hash h;
+  h.add( uint64_t(CACHE_KEY_VERSION) );
+  h.add( what );
+  h.add( uint64_t(ccdata.nrow()) );
+  h.add( uint64_t(ccdata.ncol()) );
+  for( IntegerMatrix::const_iterator itr = ccdata.begin() ; itr != ccdata.end() ; ++itr )
+    {
+      h.add( uint64_t(uint32_t(*itr)) );
+    }
+  h.add( uint64_t(ccstatus.size()) );
+  for( IntegerVector::const_iterator itr = ccstatus.begin() ; itr != ccstatus.end() ; ++itr )
+    {
+      h.add( uint64_t(uint32_t(*itr)) );
+    }
+  h.add( uint64_t(params.size()) );
+  for( NumericVector::const_iterator itr = params.begin() ; itr != params.end() ; ++itr )
+    {
+      h.add( double(*itr) );
+    }
+  return h.hex();
+}
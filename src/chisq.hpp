@@ -1,10 +0,0 @@
-#ifndef __CHISQ_HPP__
-#define __CHISQ_HPP__
-
-double chisq(const unsigned & a,
-	     const unsigned & b,
-	     const unsigned & c,
-	     const unsigned & d,
-	     const bool & yates = true);
-
-#endif
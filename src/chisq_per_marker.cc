@@ -1,18 +1,55 @@
 #include <chisq_per_marker.hpp>
-#include <stat_chisq.hpp>
-#include <stat_calculator.hpp>
+#include <chisq.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <cmath>
 #include <Rmath.h>
+#include <vector>
 
 using namespace std;
 using namespace Rcpp;
 
+namespace {
+  //Genotypes copied into bytes at once by chisq_per_marker and fisher_per_marker
+  const unsigned CHISQ_BLOCK_CELLS = 1u << 26;
+
+  //-log10 p-values of Fisher's exact test if exact, otherwise of the chi-squared test
+  NumericVector per_marker( const IntegerMatrix & ccdata,
+			    const IntegerVector & ccstatus,
+			    const bool & exact,
+			    const char * fname )
+  {
+    if( ccstatus.size() != ccdata.nrow() )
+      {
+	stop(string(fname) + ": length(ccstatus) != nrow(ccdata)");
+      }
+    //Only a block of markers at a time is copied into bytes, so a very large matrix is not copied whole
+    const unsigned nr = ccdata.nrow(), nc = ccdata.ncol(),
+      block = max( 1u, CHISQ_BLOCK_CELLS/max(nr,1u) );
+    //The margins are the same for every block, so the exact test's tables are shared by all of them
+    fisher_exact fisher(2*nr,2*(nr - unsigned(count(ccstatus.begin(),ccstatus.end(),0))));
+    NumericVector rv(nc);
+    for( unsigned first = 0 ; first < nc ; first += block )
+      {
+	const unsigned n = min(block,nc-first);
+	genotype_matrix8 G(ccdata.begin() + size_t(first)*nr,nr,n);
+	if( !G.ok )
+	  {
+	    stop(string(fname) + " error: genotype value other than 0, 1, or 2 was encountered!\n");
+	  }
+	NumericVector c = chisq_per_marker(G,ccstatus,exact ? &fisher : 0);
+	copy(c.begin(),c.end(),rv.begin()+first);
+      }
+    return rv;
+  }
+}
+
 //' Single-marker association test based on the chi-squared statistic
 //' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
 //' @return A vector of -log10(p-values) from a chi-squared test with one degree of freedom.  The chisq test is based on a 2x2 table of minor vs major allele counts in cases vs. controls.
-//' @details The chi-squared values have Yate's continuity correction applied
+//' @details The chi-squared values have Yate's continuity correction applied.
+//' Allele counts are obtained with vectorized kernels, chosen at run time for the CPU (see simd_kernel).
 //' @examples
 //' data(rec.ccdata)
 //' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
@@ -22,6 +59,63 @@ using namespace Rcpp;
 NumericVector chisq_per_marker( const IntegerMatrix & ccdata,
 				const IntegerVector & ccstatus )
 {
-  stat_chisq f;
-  return ( as<NumericVector>(stat_calculator( ccdata, ccstatus, f )["values"]) );
+  return per_marker(ccdata,ccstatus,false,"chisq_per_marker");
+}
+
+//' Single-marker association test based on Fisher's exact test
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @return A vector of -log10(p-values) from a two-sided Fisher's exact test of the same 2x2 table of minor vs major allele counts in cases vs. controls
+//' used by chisq_per_marker.
+//' @details The p-values are those of fisher.test applied to each marker's table, and are preferable to chisq_per_marker's when minor allele counts are small.
+//' Hypergeometric probabilities are calculated from a table of log factorials.  The p-values for a given number of minor alleles are calculated once,
+//' and reused for every marker with that number of minor alleles, so the test costs little more than chisq_per_marker when the variants are rare.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' rec.ccdata.fisher = fisher_per_marker(rec.ccdata$genos, status)
+// [[Rcpp::export]]
+NumericVector fisher_per_marker( const IntegerMatrix & ccdata,
+				 const IntegerVector & ccstatus )
+{
+  return per_marker(ccdata,ccstatus,true,"fisher_per_marker");
+}
+
+genotype_matrix8 chisq_genotypes( const IntegerMatrix & ccdata )
+{
+  genotype_matrix8 G(ccdata.begin(),ccdata.nrow(),ccdata.ncol());
+  if( !G.ok )
+    {
+      stop("chisq_per_marker error: genotype value other than 0, 1, or 2 was encountered!\n");
+    }
+  return G;
+}
+
+NumericVector chisq_per_marker( const genotype_matrix8 & G,
+				const IntegerVector & ccstatus,
+				fisher_exact * fisher )
+{
+  vector<uint8_t> mask;
+  const unsigned ncases = case_mask(ccstatus.begin(),ccstatus.end(),G.stride,mask),
+    ncontrols = G.nrow - ncases;
+  NumericVector rv(G.ncol);
+  site_counts c;
+  for( unsigned j = 0 ; j < G.ncol ; ++j )
+    {
+      count_site(G.column(j),&mask[0],G.stride,c);
+      const unsigned control_minor = c.dosage - c.case_dosage;
+      rv[j] = fisher ? fisher->log10p( c.dosage, c.case_dosage ) :
+	chisq_log10p( control_minor, 2*ncontrols - control_minor,
+		      c.case_dosage, 2*ncases - c.case_dosage );
+    }
+  return rv;
+}
+
+//' The vectorized kernel used for genotype counting on this machine
+//' @return One of "avx512bw", "avx2", "sse4.2", or "scalar".
+//' @details The kernel is chosen when the package is loaded, based on what the CPU supports.
+// [[Rcpp::export]]
+std::string simd_kernel()
+{
+  return std::string( genotype_kernel_isa() );
 }
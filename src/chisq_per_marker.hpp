@@ -2,9 +2,26 @@
 #define __CHISQ_PER_MARKER_HPP__
 
 #include <Rcpp.h>
+#include <genotype_kernels.hpp>
+#include <fisher_exact.hpp>
 
 Rcpp::NumericVector chisq_per_marker( const Rcpp::IntegerMatrix & ccdata,
 				      const Rcpp::IntegerVector & ccstatus );
 
+/*
+  Same, for genotypes already copied into bytes.  Use this to avoid repeating the copy for each permutation.
+  If fisher is not null, it is used in place of the chi-squared test.  Its margins must match G and ccstatus.
+*/
+Rcpp::NumericVector chisq_per_marker( const genotype_matrix8 & G,
+				      const Rcpp::IntegerVector & ccstatus,
+				      fisher_exact * fisher = 0 );
+
+//Fisher's exact test in place of the chi-squared
+Rcpp::NumericVector fisher_per_marker( const Rcpp::IntegerMatrix & ccdata,
+				       const Rcpp::IntegerVector & ccstatus );
+
+//Copies genotypes into bytes, and stops if any genotype is not 0, 1, or 2
+genotype_matrix8 chisq_genotypes( const Rcpp::IntegerMatrix & ccdata );
+
 
 #endif
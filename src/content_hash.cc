@@ -0,0 +1,59 @@
+#include <content_hash.hpp>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+  inline uint64_t splitmix64_mix( uint64_t z )
+  {
+    z = (z ^ (z >> 30)) * uint64_t(0xBF58476D1CE4E5B9ULL);
+    z = (z ^ (z >> 27)) * uint64_t(0x94D049BB133111EBULL);
+    return z ^ (z >> 31);
+  }
+  const uint64_t GOLDEN_GAMMA = uint64_t(0x9E3779B97F4A7C15ULL);
+}
+
+content_hash::content_hash() : h1(uint64_t(0x6A09E667F3BCC908ULL)),
+			       h2(uint64_t(0xBB67AE8584CAA73BULL)),
+			       nwords(0)
+{
+}
+
+void content_hash::add( const uint64_t & x )
+{
+  h1 = splitmix64_mix( h1 ^ x );
+  h2 = splitmix64_mix( h2 + x + GOLDEN_GAMMA ) ^ h1;
+  ++nwords;
+}
+
+void content_hash::add( const double & x )
+{
+  //0 and -0 are the same value
+  const double y = (x == 0.) ? 0. : x;
+  uint64_t bits;
+  memcpy(&bits,&y,sizeof(double));
+  add(bits);
+}
+
+void content_hash::add( const string & s )
+{
+  add( uint64_t(s.size()) );
+  for( string::size_type i = 0 ; i < s.size() ; ++i )
+    {
+      add( uint64_t((unsigned char)(s[i])) );
+    }
+}
+
+string content_hash::hex() const
+{
+  //the number of words separates inputs that are prefixes of each other
+  const uint64_t a = splitmix64_mix( h1 ^ splitmix64_mix(nwords) ), b = splitmix64_mix( h2 + a );
+  const char * digits = "0123456789abcdef";
+  string rv(32,'0');
+  for( unsigned i = 0 ; i < 16 ; ++i )
+    {
+      rv[i] = digits[ (a >> (60-4*i)) & 0xF ];
+      rv[16+i] = digits[ (b >> (60-4*i)) & 0xF ];
+    }
+  return rv;
+}
@@ -0,0 +1,28 @@
+#ifndef __CONTENT_HASH_HPP__
+#define __CONTENT_HASH_HPP__
+
+#include <stdint.h>
+#include <string>
+
+/*
+  128-bit hash of a stream of values, used to name cached results by their inputs.
+
+  Values are fed in as integers, not as raw memory, so that the same inputs give
+  the same key on every platform.  Each lane chains the SplitMix64 finalizer,
+  which is a bijection, over the input words.  This is not a cryptographic hash:
+  it guards against accidental collisions, not against inputs built to collide.
+ */
+class content_hash
+{
+private:
+  uint64_t h1,h2,nwords;
+public:
+  content_hash();
+  void add( const uint64_t & x );
+  void add( const double & x );
+  void add( const std::string & s );
+  //32 hexadecimal digits
+  std::string hex() const;
+};
+
+#endif
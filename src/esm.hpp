@@ -2,6 +2,7 @@
 #define __ESM_HPP__
 
 #include <Rcpp.h>
+#include <esm_stat.hpp>
 
 double esm( const Rcpp::NumericVector & scores, const unsigned & K );
 
@@ -2,6 +2,7 @@
 #include <esm.hpp>
 #include <chisq_per_marker.hpp>
 #include <randWrapper.hpp>
+#include <validate.hpp>
 
 #include <algorithm>
 
@@ -12,6 +13,7 @@ using namespace std;
 //' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
 //' @param k The number of markers for the ESM_K statistic.
+//' @param fisher If TRUE, use Fisher's exact test for each marker (see fisher_per_marker) in place of the chi-squared test.
 //' @return The ESM_K test statistic value based on chi-squared tests per marker.
 //' @references Thornton, K. R., Foran, A. J., & Long, A. D. (2013). Properties and Modeling of GWAS when Complex Disease Risk Is Due to Non-Complementing, Deleterious Mutations in Genes of Large Effect. PLoS Genetics, 9(2), e1003258. doi:10.1371/journal.pgen.1003258
 //' @examples
@@ -23,9 +25,10 @@ using namespace std;
 // [[Rcpp::export]]
 double esm_chisq( const IntegerMatrix & ccdata,
 		  const IntegerVector & ccstatus,
-		  const unsigned & k)
+		  const unsigned & k,
+		  const bool & fisher = false)
 {
-  NumericVector c = chisq_per_marker( ccdata, ccstatus );
+  NumericVector c = fisher ? fisher_per_marker( ccdata, ccstatus ) : chisq_per_marker( ccdata, ccstatus );
   double stat = esm(c,k);
   return( stat );
 }
@@ -35,6 +38,8 @@ double esm_chisq( const IntegerMatrix & ccdata,
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
 //' @param nperms Number of permutations to perform
 //' @param k Number of markers to use for ESM_K statistic
+//' @param fisher If TRUE, use Fisher's exact test for each marker in place of the chi-squared test.
+//' The numbers of cases and controls are the same in every permutation, so the exact test's p-values are calculated once for all permutations.
 //' @return A vector of the permuted test statistic values
 //' @references Thornton, K. R., Foran, A. J., & Long, A. D. (2013). Properties and Modeling of GWAS when Complex Disease Risk Is Due to Non-Complementing, Deleterious Mutations in Genes of Large Effect. PLoS Genetics, 9(2), e1003258. doi:10.1371/journal.pgen.1003258
 //' @examples
@@ -49,17 +54,64 @@ double esm_chisq( const IntegerMatrix & ccdata,
 NumericVector esm_perm_binary( const IntegerMatrix & ccdata,
 			       const IntegerVector & ccstatus,
 			       const unsigned & nperms,
-			       const unsigned & k )
+			       const unsigned & k,
+			       const bool & fisher = false )
 {
   NumericVector rv(nperms);
   RNGScope scope;
   IntegerVector status = clone(ccstatus);
+  //Genotypes are copied into bytes once, for all permutations
+  genotype_matrix8 G = chisq_genotypes(ccdata);
+  fisher_exact exact(2*G.nrow,2*(G.nrow - unsigned(count(status.begin(),status.end(),0))));
 
   for( unsigned i = 0 ; i < nperms ; ++i )
     {
       random_shuffle(status.begin(),status.end(),randWrapper);
-      NumericVector c = chisq_per_marker( ccdata, status );
+      NumericVector c = chisq_per_marker( G, status, fisher ? &exact : 0 );
       rv[i] = esm(c,k);
+      checkUserInterrupt();
+    }
+  return rv;
+}
+
+//' Permutation distribution of the ESM_K statistic from a permutation plan
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param k Number of markers to use for ESM_K statistic
+//' @param fisher If TRUE, use Fisher's exact test for each marker in place of the chi-squared test.
+//' @return A vector of the permuted test statistic values, the same as esm_perm_binary, with one value per permutation of the plan.
+//' @details ccstatus is only used to check that the plan has the same numbers of individuals and cases.  The labels of each permutation
+//' are read from the plan as they are needed.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' plan = permPlan(status,100,101)
+//' rec.ccdata.esm.permdist = esm_perm_plan(rec.ccdata$genos[,which(keep==1)],status,plan,50)
+// [[Rcpp::export]]
+NumericVector esm_perm_plan( const IntegerMatrix & ccdata,
+			     const IntegerVector & ccstatus,
+			     XPtr<perm_plan> plan,
+			     const unsigned & k,
+			     const bool & fisher = false )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("esm_perm_plan: length(ccstatus) != nrow(ccdata)");
+    }
+  const perm_plan * p = validate_plan(plan,ccstatus,"esm_perm_plan");
+  NumericVector rv(p->nperms);
+  IntegerVector status(p->n);
+  genotype_matrix8 G = chisq_genotypes(ccdata);
+  fisher_exact exact(2*G.nrow,2*p->ncases);
+
+  for( unsigned i = 0 ; i < p->nperms ; ++i )
+    {
+      p->labels(i,status.begin());
+      NumericVector c = chisq_per_marker( G, status, fisher ? &exact : 0 );
+      rv[i] = esm(c,k);
+      checkUserInterrupt();
     }
   return rv;
 }
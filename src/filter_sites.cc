@@ -14,6 +14,7 @@ using namespace Rcpp;
 //' @param rsq_cutoff  When comparing two sites, if the genotype correlation coefficient r^2 is >= rsq_cutoff, only the first site will be kept.
 //' @return A vector of integers containing the values 0 (not kept) and 1 (kept).  The length of the vector is equal to the number of columns in ccdata.
 //' @details Regarding rsq_cutoff, when sites i and j are compared (j > i), site i will be kept and site j will not be kept.
+//' See siteQC for filters on call rate, Hardy-Weinberg equilibrium, and missingness, applied together with these in one pass over the data.
 //' @examples
 //' data(rec.ccdata)
 //' status=c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
@@ -33,7 +34,7 @@ Rcpp::IntegerVector filter_sites(const Rcpp::IntegerMatrix & ccdata,
   Rcpp::IntegerVector keep(ccdata.ncol(),1);
 
   unsigned ncontrols = count( ccstatus.begin(),ccstatus.end(),0 );
-  for( unsigned site_i = 0 ; site_i < ccdata.ncol() - 1 ; ++site_i )
+  for( unsigned site_i = 0 ; site_i + 1 < unsigned(ccdata.ncol()) ; ++site_i )
     {
       if ( keep[site_i] )
 	{
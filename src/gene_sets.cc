@@ -0,0 +1,202 @@
+#include <Rcpp.h>
+#include <stat_multitrait.hpp>
+#include <sparse_genotypes.hpp>
+#include <perm_rng.hpp>
+#include <power_study.hpp>
+#include <validate.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+namespace {
+  //1-based indexes, checked against [1,max]
+  vector< vector<unsigned> > index_list( const List & l, const unsigned & max, const char * what )
+  {
+    vector< vector<unsigned> > rv(l.size());
+    for( R_xlen_t i = 0 ; i < l.size() ; ++i )
+      {
+	IntegerVector x = as<IntegerVector>(l[i]);
+	for( R_xlen_t j = 0 ; j < x.size() ; ++j )
+	  {
+	    if( x[j] == NA_INTEGER || x[j] < 1 || unsigned(x[j]) > max )
+	      {
+		stop( string("geneSetBurdenStats: ") + what + " out of range" );
+	      }
+	    rv[i].push_back(unsigned(x[j]-1));
+	  }
+      }
+    return rv;
+  }
+
+  //Statistics of every set, for the traits of f
+  void score_sets( const stat_multitrait & f,
+		   const vector<sparse_genotypes> & genes,
+		   const vector<site_patterns> & patterns,
+		   const vector< vector<unsigned> > & sets,
+		   const unsigned & esm_K,
+		   const double & LLc_maf,
+		   const bool & LLc_maf_control,
+		   const bool & normalize_calpha,
+		   const bool & simplecount_calpha,
+		   const bool & esm_fisher,
+		   vector<multitrait_values> & rv )
+  {
+    //Each gene is read once, no matter how many sets it belongs to
+    vector<multitrait_partial> parts(genes.size());
+    for( unsigned g = 0 ; g < genes.size() ; ++g )
+      {
+	f.partial(genes[g],LLc_maf,LLc_maf_control,simplecount_calpha,parts[g],&patterns[g],esm_fisher);
+      }
+    rv.resize(sets.size());
+    vector<const multitrait_partial *> members;
+    for( unsigned s = 0 ; s < sets.size() ; ++s )
+      {
+	members.clear();
+	for( unsigned k = 0 ; k < sets[s].size() ; ++k ) members.push_back(&parts[sets[s][k]]);
+	f.combine(members,esm_K,normalize_calpha,rv[s]);
+      }
+  }
+}
+
+//' Burden statistics of gene sets
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param genes A list of vectors of column indexes of ccdata, one per gene
+//' @param sets A list of vectors of indexes into genes, one per gene set (e.g. pathway)
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param nperms Number of permutations used to obtain p-values.  If 0, no permutations are done.
+//' @param seed Random number seed for the permutations
+//' @param esm_fisher see allBurdenStats
+//' @return A list.  stats is a data frame with the number of markers in each set and the statistics of allBurdenStats (except esm.K)
+//' for the markers of the set.  If nperms > 0, p.values is a data frame with the Monte-carlo estimate of P(permuted statistic >= observed statistic)
+//' for each set and statistic.
+//' @details Each gene's contribution to the statistics (its markers' -log10 p-values, its c-alpha terms, and its carriers' Madsen-Browning
+//' scores and Li-Leal rare variant status) is calculated once, and the statistics of each set are made from the contributions of its genes,
+//' so the genotypes are read once no matter how many sets a gene belongs to.  Permutations are done in blocks, and every gene and set in a block is
+//' scored with the same permuted labels.  Permutation i is the same as permutation i of allBurdenStatsPermShard with the same seed.
+//' The genes of a set should not share markers: a marker in two genes of the same set is counted twice.  Otherwise, a set's statistics are those
+//' of allBurdenStats on the markers of its genes, except that Madsen-Browning scores and the c-alpha sum are added gene by gene, and may differ
+//' in the last few bits.  Individuals whose Madsen-Browning scores are equal up to rounding may therefore be ranked as tied in one and not the other.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' genes = list(1:20,21:40,41:60)
+//' sets = list(c(1,2),c(2,3),3)
+//' res = geneSetBurdenStats(rec.ccdata$genos,status,genes,sets,10,0.05,nperms=100,seed=101)
+// [[Rcpp::export]]
+List geneSetBurdenStats( const IntegerMatrix & ccdata,
+			 const IntegerVector & ccstatus,
+			 const List & genes,
+			 const List & sets,
+			 const unsigned & esm_K,
+			 const double & LLc_maf,
+			 const bool & LLc_maf_control = true,
+			 const bool normalize_calpha = false,
+			 const bool simplecount_calpha = false,
+			 const unsigned & nperms = 0,
+			 const unsigned & seed = 0,
+			 const bool esm_fisher = false )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("geneSetBurdenStats: length(ccstatus) != nrow(ccdata)");
+    }
+  validate_labels(ccstatus,"geneSetBurdenStats");
+  const sparse_genotypes G = validate_genotypes(ccdata,"geneSetBurdenStats");
+  const vector< vector<unsigned> > gene_columns = index_list(genes,G.ncol,"marker index"),
+    set_genes = index_list(sets,gene_columns.size(),"gene index");
+  vector<sparse_genotypes> gene_genotypes;
+  vector<site_patterns> gene_patterns;
+  gene_genotypes.reserve(gene_columns.size());
+  gene_patterns.reserve(gene_columns.size());
+  for( unsigned g = 0 ; g < gene_columns.size() ; ++g )
+    {
+      gene_genotypes.push_back( sparse_genotypes(G,gene_columns[g]) );
+      gene_patterns.push_back( site_patterns(gene_genotypes.back()) );
+    }
+
+  const unsigned n = G.nrow, nsets = set_genes.size();
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  vector<multitrait_values> observed;
+  score_sets(stat_multitrait(status.empty() ? 0 : &status[0],n,1),gene_genotypes,gene_patterns,set_genes,
+	     esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,esm_fisher,observed);
+
+  IntegerVector nsites(nsets);
+  NumericVector esm(nsets),calpha(nsets),MBg(nsets),MBr(nsets),MBd(nsets),LLc(nsets);
+  for( unsigned s = 0 ; s < nsets ; ++s )
+    {
+      for( unsigned k = 0 ; k < set_genes[s].size() ; ++k ) nsites[s] += gene_columns[set_genes[s][k]].size();
+      esm[s] = observed[s].esm[0];
+      calpha[s] = observed[s].calpha[0];
+      MBg[s] = observed[s].MBg[0];
+      MBr[s] = observed[s].MBr[0];
+      MBd[s] = observed[s].MBd[0];
+      LLc[s] = observed[s].LLc[0];
+    }
+  DataFrame sdf = DataFrame::create( Named("nsites") = nsites,
+				     Named("esm.stat") = esm,
+				     Named("calpha.stat") = calpha,
+				     Named("MB.general.stat") = MBg,
+				     Named("MB.recessive.stat") = MBr,
+				     Named("MB.dominant.stat") = MBd,
+				     Named("LL.collapse.stat") = LLc );
+  if( nperms == 0 )
+    {
+      return List::create( Named("stats") = sdf );
+    }
+
+  //Permutation i uses stream i-1, as in allBurdenStatsPermShard
+  NumericVector esm_p(nsets),calpha_p(nsets),MBg_p(nsets),MBr_p(nsets),MBd_p(nsets),LLc_p(nsets);
+  vector<int> labels;
+  vector<multitrait_values> permuted;
+  for( unsigned first = 0 ; first < nperms ; first += POWER_PERM_BLOCK )
+    {
+      const unsigned B = min(POWER_PERM_BLOCK,nperms-first);
+      labels.resize(size_t(n)*B);
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  vector<int>::iterator col = labels.begin() + size_t(b)*n;
+	  copy(status.begin(),status.end(),col);
+	  perm_rng rng(seed,first+b);
+	  perm_shuffle(col,col+n,rng);
+	}
+      score_sets(stat_multitrait(&labels[0],n,B),gene_genotypes,gene_patterns,set_genes,
+		 esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,esm_fisher,permuted);
+      for( unsigned s = 0 ; s < nsets ; ++s )
+	{
+	  for( unsigned b = 0 ; b < B ; ++b )
+	    {
+	      if( permuted[s].esm[b] >= esm[s] ) esm_p[s] += 1.;
+	      if( permuted[s].calpha[b] >= calpha[s] ) calpha_p[s] += 1.;
+	      if( permuted[s].MBg[b] >= MBg[s] ) MBg_p[s] += 1.;
+	      if( permuted[s].MBr[b] >= MBr[s] ) MBr_p[s] += 1.;
+	      if( permuted[s].MBd[b] >= MBd[s] ) MBd_p[s] += 1.;
+	      if( permuted[s].LLc[b] >= LLc[s] ) LLc_p[s] += 1.;
+	    }
+	}
+      checkUserInterrupt();
+    }
+  for( unsigned s = 0 ; s < nsets ; ++s )
+    {
+      esm_p[s] /= double(nperms);
+      calpha_p[s] /= double(nperms);
+      MBg_p[s] /= double(nperms);
+      MBr_p[s] /= double(nperms);
+      MBd_p[s] /= double(nperms);
+      LLc_p[s] /= double(nperms);
+    }
+  DataFrame pdf = DataFrame::create( Named("esm.stat") = esm_p,
+				     Named("calpha.stat") = calpha_p,
+				     Named("MB.general.stat") = MBg_p,
+				     Named("MB.recessive.stat") = MBr_p,
+				     Named("MB.dominant.stat") = MBd_p,
+				     Named("LL.collapse.stat") = LLc_p );
+  return List::create( Named("stats") = sdf,
+		       Named("p.values") = pdf );
+}
@@ -0,0 +1,183 @@
+#include <genotype_kernels.hpp>
+#include <algorithm>
+
+#if !defined(BURDEN_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BURDEN_X86_DISPATCH
+#include <immintrin.h>
+#if defined(__clang__) || __GNUC__ >= 5
+#define BURDEN_HAVE_AVX512
+#endif
+#endif
+
+using namespace std;
+
+genotype_matrix8::genotype_matrix8( const int * data,
+				    const unsigned & __nrow,
+				    const unsigned & __ncol ) : nrow(__nrow),
+								ncol(__ncol),
+								stride( max(1u,(__nrow+GENOTYPE_PAD-1)/GENOTYPE_PAD)*GENOTYPE_PAD ),
+								genos(vector<uint8_t>(size_t(stride)*size_t(__ncol),0)),
+								ok(true)
+{
+  for( unsigned j = 0 ; j < ncol ; ++j )
+    {
+      uint8_t * col = &genos[size_t(j)*stride];
+      for( unsigned i = 0 ; i < nrow ; ++i, ++data )
+	{
+	  if( *data < 0 || *data > 2 ) ok = false;
+	  col[i] = uint8_t(*data);
+	}
+    }
+}
+
+const uint8_t * genotype_matrix8::column( const unsigned & j ) const
+{
+  return &genos[size_t(j)*stride];
+}
+
+namespace {
+  typedef void (*count_kernel)(const uint8_t *, const uint8_t *, const unsigned &, site_counts &);
+
+  void count_scalar( const uint8_t * g, const uint8_t * m, const unsigned & n, site_counts & c )
+  {
+    c.dosage = c.case_dosage = c.carriers = c.case_carriers = 0;
+    for( unsigned i = 0 ; i < n ; ++i )
+      {
+	const unsigned carrier = (g[i] > 0);
+	c.dosage += g[i];
+	c.carriers += carrier;
+	if( m[i] )
+	  {
+	    c.case_dosage += g[i];
+	    c.case_carriers += carrier;
+	  }
+      }
+  }
+
+#ifdef BURDEN_X86_DISPATCH
+  /*
+    All versions use the same idea: min(g,1) is the carrier indicator,
+    AND-ing with the mask keeps cases, and sum of absolute differences
+    against zero adds up bytes into 64-bit lanes.
+    Only SSE2 instructions are needed for the 128-bit version, but it is
+    selected on SSE4.2 hardware, which is the baseline of current x86 clusters.
+  */
+  inline unsigned sum_lanes( const uint64_t * lanes, const unsigned & n )
+  {
+    uint64_t s = 0;
+    for( unsigned i = 0 ; i < n ; ++i ) s += lanes[i];
+    return unsigned(s);
+  }
+
+  __attribute__((target("sse4.2")))
+  void count_sse42( const uint8_t * g, const uint8_t * m, const unsigned & n, site_counts & c )
+  {
+    const __m128i zero = _mm_setzero_si128(), one = _mm_set1_epi8(1);
+    __m128i d = zero, cd = zero, k = zero, ck = zero;
+    for( unsigned i = 0 ; i < n ; i += 16 )
+      {
+	const __m128i x = _mm_loadu_si128( reinterpret_cast<const __m128i *>(g+i) );
+	const __m128i mk = _mm_loadu_si128( reinterpret_cast<const __m128i *>(m+i) );
+	const __m128i carrier = _mm_min_epu8(x,one);
+	d = _mm_add_epi64( d, _mm_sad_epu8(x,zero) );
+	cd = _mm_add_epi64( cd, _mm_sad_epu8(_mm_and_si128(x,mk),zero) );
+	k = _mm_add_epi64( k, _mm_sad_epu8(carrier,zero) );
+	ck = _mm_add_epi64( ck, _mm_sad_epu8(_mm_and_si128(carrier,mk),zero) );
+      }
+    uint64_t lanes[2];
+    _mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), d ); c.dosage = sum_lanes(lanes,2);
+    _mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), cd ); c.case_dosage = sum_lanes(lanes,2);
+    _mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), k ); c.carriers = sum_lanes(lanes,2);
+    _mm_storeu_si128( reinterpret_cast<__m128i *>(lanes), ck ); c.case_carriers = sum_lanes(lanes,2);
+  }
+
+  __attribute__((target("avx2")))
+  void count_avx2( const uint8_t * g, const uint8_t * m, const unsigned & n, site_counts & c )
+  {
+    const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi8(1);
+    __m256i d = zero, cd = zero, k = zero, ck = zero;
+    for( unsigned i = 0 ; i < n ; i += 32 )
+      {
+	const __m256i x = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(g+i) );
+	const __m256i mk = _mm256_loadu_si256( reinterpret_cast<const __m256i *>(m+i) );
+	const __m256i carrier = _mm256_min_epu8(x,one);
+	d = _mm256_add_epi64( d, _mm256_sad_epu8(x,zero) );
+	cd = _mm256_add_epi64( cd, _mm256_sad_epu8(_mm256_and_si256(x,mk),zero) );
+	k = _mm256_add_epi64( k, _mm256_sad_epu8(carrier,zero) );
+	ck = _mm256_add_epi64( ck, _mm256_sad_epu8(_mm256_and_si256(carrier,mk),zero) );
+      }
+    uint64_t lanes[4];
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), d ); c.dosage = sum_lanes(lanes,4);
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), cd ); c.case_dosage = sum_lanes(lanes,4);
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), k ); c.carriers = sum_lanes(lanes,4);
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>(lanes), ck ); c.case_carriers = sum_lanes(lanes,4);
+  }
+
+#ifdef BURDEN_HAVE_AVX512
+  __attribute__((target("avx512f,avx512bw")))
+  void count_avx512( const uint8_t * g, const uint8_t * m, const unsigned & n, site_counts & c )
+  {
+    const __m512i zero = _mm512_setzero_si512(), one = _mm512_set1_epi8(1);
+    __m512i d = zero, cd = zero, k = zero, ck = zero;
+    for( unsigned i = 0 ; i < n ; i += 64 )
+      {
+	const __m512i x = _mm512_loadu_si512( reinterpret_cast<const void *>(g+i) );
+	const __m512i mk = _mm512_loadu_si512( reinterpret_cast<const void *>(m+i) );
+	const __m512i carrier = _mm512_min_epu8(x,one);
+	d = _mm512_add_epi64( d, _mm512_sad_epu8(x,zero) );
+	cd = _mm512_add_epi64( cd, _mm512_sad_epu8(_mm512_and_si512(x,mk),zero) );
+	k = _mm512_add_epi64( k, _mm512_sad_epu8(carrier,zero) );
+	ck = _mm512_add_epi64( ck, _mm512_sad_epu8(_mm512_and_si512(carrier,mk),zero) );
+      }
+    uint64_t lanes[8];
+    _mm512_storeu_si512( reinterpret_cast<void *>(lanes), d ); c.dosage = sum_lanes(lanes,8);
+    _mm512_storeu_si512( reinterpret_cast<void *>(lanes), cd ); c.case_dosage = sum_lanes(lanes,8);
+    _mm512_storeu_si512( reinterpret_cast<void *>(lanes), k ); c.carriers = sum_lanes(lanes,8);
+    _mm512_storeu_si512( reinterpret_cast<void *>(lanes), ck ); c.case_carriers = sum_lanes(lanes,8);
+  }
+#endif
+#endif
+
+  struct kernel_choice
+  {
+    count_kernel f;
+    const char * isa;
+    kernel_choice() : f(count_scalar), isa("scalar")
+    {
+#ifdef BURDEN_X86_DISPATCH
+      __builtin_cpu_init();
+#ifdef BURDEN_HAVE_AVX512
+      if( __builtin_cpu_supports("avx512bw") )
+	{
+	  f = count_avx512;
+	  isa = "avx512bw";
+	  return;
+	}
+#endif
+      if( __builtin_cpu_supports("avx2") )
+	{
+	  f = count_avx2;
+	  isa = "avx2";
+	}
+      else if( __builtin_cpu_supports("sse4.2") )
+	{
+	  f = count_sse42;
+	  isa = "sse4.2";
+	}
+#endif
+    }
+  };
+
+  //Chosen once, when the library is loaded
+  const kernel_choice KERNEL;
+}
+
+void count_site( const uint8_t * geno, const uint8_t * mask, const unsigned & n, site_counts & c )
+{
+  KERNEL.f(geno,mask,n,c);
+}
+
+const char * genotype_kernel_isa()
+{
+  return KERNEL.isa;
+}
@@ -0,0 +1,66 @@
+#ifndef __GENOTYPE_KERNELS_HPP__
+#define __GENOTYPE_KERNELS_HPP__
+
+#include <vector>
+#include <stdint.h>
+
+/*
+  Vectorized per-site reductions of genotypes against a case mask.
+
+  Genotypes are copied once into one byte per individual, and each site's
+  column is padded with zeros to a multiple of GENOTYPE_PAD individuals.  The
+  case mask is one byte per individual as well: 0xFF for cases, 0 otherwise.
+  For one site, count_site then returns the minor allele count (dosage) and
+  the number of carriers, over all individuals and over cases only.  Control
+  counts are the differences.
+
+  There are SSE4.2, AVX2 and AVX-512BW versions of the kernel, plus a scalar
+  fallback.  The fastest one that the CPU supports is chosen when the library
+  is loaded, so one build runs at full speed on every x86 machine.  Defining
+  BURDEN_NO_SIMD at compile time forces the scalar kernel.
+ */
+
+const unsigned GENOTYPE_PAD = 64;
+
+struct site_counts
+{
+  unsigned dosage,case_dosage,carriers,case_carriers;
+};
+
+class genotype_matrix8
+{
+public:
+  unsigned nrow,ncol,stride;
+  //column-major, stride bytes per column
+  std::vector<uint8_t> genos;
+  //false if any genotype was not 0, 1, or 2
+  bool ok;
+  //data is column-major, like an R matrix
+  genotype_matrix8( const int * data, const unsigned & __nrow, const unsigned & __ncol );
+  const uint8_t * column( const unsigned & j ) const;
+};
+
+//Fills mask (padded to stride) from labels, treating any non-zero label as a case.  Returns the number of cases.
+template<typename iterator>
+unsigned case_mask( iterator beg, iterator end, const unsigned & stride, std::vector<uint8_t> & mask )
+{
+  mask.assign(stride,0);
+  unsigned ncases = 0;
+  for( unsigned i = 0 ; beg != end ; ++beg, ++i )
+    {
+      if( *beg != 0 )
+	{
+	  mask[i] = 0xFF;
+	  ++ncases;
+	}
+    }
+  return ncases;
+}
+
+//n must be a multiple of GENOTYPE_PAD
+void count_site( const uint8_t * geno, const uint8_t * mask, const unsigned & n, site_counts & c );
+
+//The kernel chosen at run time: "avx512bw", "avx2", "sse4.2", or "scalar"
+const char * genotype_kernel_isa();
+
+#endif
@@ -0,0 +1,169 @@
+#include <gpd_tail.hpp>
+#include <perm_rng.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace {
+  //|shape| below this is treated as the exponential limit of the GPD
+  const double SHAPE_EPS = 1e-8;
+  //Fewer exceedances than this are not worth fitting
+  const unsigned MIN_EXCEED = 10;
+
+  //Zhang-Stephens k(theta) = -mean(log(1-theta*y))
+  double zs_k( const vector<double> & y, const double & theta )
+  {
+    double s = 0.;
+    for( vector<double>::const_iterator itr = y.begin() ; itr != y.end() ; ++itr )
+      {
+	s += log1p(-theta*(*itr));
+      }
+    return -s/double(y.size());
+  }
+}
+
+gpd_fit::gpd_fit() : ok(false),
+		     shape(numeric_limits<double>::quiet_NaN()),
+		     scale(numeric_limits<double>::quiet_NaN()),
+		     threshold(numeric_limits<double>::quiet_NaN()),
+		     nexceed(0),
+		     gof_p(numeric_limits<double>::quiet_NaN())
+{
+}
+
+bool gpd_estimate( const vector<double> & y, double & shape, double & scale )
+{
+  const unsigned n = y.size();
+  if( n < 2 ) return false;
+  const double xstar = y[ unsigned( double(n)/4. + 0.5 ) - 1 ]; //first quartile
+  const double xmax = y[n-1];
+  if( !(xstar > 0.) || !(xmax > 0.) ) return false;
+
+  const unsigned m = 20 + unsigned(sqrt(double(n)));
+  vector<double> theta(m),lik(m);
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      theta[j] = 1./xmax + (1. - sqrt( double(m)/(double(j+1)-0.5) ))/(3.*xstar);
+      double k = zs_k(y,theta[j]);
+      //profile log-likelihood
+      lik[j] = double(n)*( log(theta[j]/k) + k - 1. );
+    }
+  //posterior-mean-like weights; computed relative to each lik[j] to avoid overflow
+  double thetahat = 0.;
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      double denom = 0.;
+      for( unsigned l = 0 ; l < m ; ++l )
+	{
+	  denom += exp( lik[l]-lik[j] );
+	}
+      thetahat += theta[j]/denom;
+    }
+  if( !isfinite(thetahat) || thetahat == 0. ) return false;
+  const double k = zs_k(y,thetahat);
+  //Zhang & Stephens parameterize by k = -shape and sigma = k/theta
+  shape = -k;
+  scale = k/thetahat;
+  return ( isfinite(shape) && isfinite(scale) && scale > 0. );
+}
+
+namespace {
+  //log of the survival function, 1-F(y)
+  double gpd_logsf( const double & y, const double & shape, const double & scale )
+  {
+    if( y <= 0. ) return 0.;
+    if( fabs(shape) < SHAPE_EPS ) return -y/scale;
+    double inner = shape*y/scale;
+    if( inner <= -1. ) return -numeric_limits<double>::infinity(); //beyond the upper end point when shape < 0
+    return -log1p(inner)/shape;
+  }
+}
+
+double gpd_cdf( const double & y, const double & shape, const double & scale )
+{
+  return -expm1( gpd_logsf(y,shape,scale) );
+}
+
+double gpd_anderson_darling( const vector<double> & y, const double & shape, const double & scale )
+{
+  const unsigned n = y.size();
+  const double lo = numeric_limits<double>::min(), hi = 1. - numeric_limits<double>::epsilon();
+  vector<double> z(n);
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      z[i] = min( max( gpd_cdf(y[i],shape,scale), lo ), hi );
+    }
+  double s = 0.;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      s += double(2*i+1)*( log(z[i]) + log1p(-z[n-1-i]) );
+    }
+  return -double(n) - s/double(n);
+}
+
+gpd_fit gpd_tail_fit( const vector<double> & largest,
+		      const unsigned & max_exceed,
+		      const unsigned & gof_reps,
+		      const double & gof_alpha,
+		      const unsigned & seed )
+{
+  gpd_fit rv;
+  //need one value beyond the exceedances to place the threshold
+  if( largest.size() < MIN_EXCEED + 1 ) return rv;
+  unsigned nexc = min( max_exceed, unsigned(largest.size()-1) );
+  perm_rng rng(seed);
+  vector<double> y,ysim;
+  while( nexc >= MIN_EXCEED )
+    {
+      //threshold half way between the nexc-th and (nexc+1)-th largest values
+      const double t = (largest[nexc-1]+largest[nexc])/2.;
+      y.resize(nexc);
+      for( unsigned i = 0 ; i < nexc ; ++i )
+	{
+	  y[i] = largest[nexc-1-i] - t; //ascending
+	}
+      double shape,scale;
+      if( gpd_estimate(y,shape,scale) )
+	{
+	  const double A2 = gpd_anderson_darling(y,shape,scale);
+	  //parametric bootstrap of A2 under the fitted GPD
+	  unsigned ge = 0;
+	  ysim.resize(nexc);
+	  for( unsigned b = 0 ; b < gof_reps ; ++b )
+	    {
+	      for( unsigned i = 0 ; i < nexc ; ++i )
+		{
+		  double u = rng.uniform();
+		  ysim[i] = ( fabs(shape) < SHAPE_EPS ) ? -scale*log1p(-u) : scale*expm1(-shape*log1p(-u))/shape;
+		}
+	      sort(ysim.begin(),ysim.end());
+	      double bshape,bscale;
+	      if( !gpd_estimate(ysim,bshape,bscale) || gpd_anderson_darling(ysim,bshape,bscale) >= A2 )
+		{
+		  ++ge;
+		}
+	    }
+	  rv.shape = shape;
+	  rv.scale = scale;
+	  rv.threshold = t;
+	  rv.nexceed = nexc;
+	  rv.gof_p = double(ge+1)/double(gof_reps+1);
+	  if( rv.gof_p > gof_alpha )
+	    {
+	      rv.ok = true;
+	      return rv;
+	    }
+	}
+      nexc -= 10;
+    }
+  return rv;
+}
+
+double gpd_tail_p( const gpd_fit & fit, const double & observed, const double & nperms )
+{
+  if( !fit.ok ) return numeric_limits<double>::quiet_NaN();
+  //1-F is computed on the log scale, which keeps precision for very small p-values
+  return ( double(fit.nexceed)/nperms )*exp( gpd_logsf(observed - fit.threshold, fit.shape, fit.scale) );
+}
@@ -0,0 +1,60 @@
+#ifndef __GPD_TAIL_HPP__
+#define __GPD_TAIL_HPP__
+
+#include <vector>
+
+/*
+  Generalized Pareto approximation to the upper tail of a permutation distribution.
+
+  When few (or no) permuted values are >= the observed statistic, the Monte-carlo
+  p-value is either imprecise or 0.  Following Knijnenburg et al. (2009), we instead
+  fit a generalized Pareto distribution (GPD) to the exceedances of the largest
+  permuted values over a threshold, and use the fit to extrapolate:
+
+  p = (nexceed/nperms) * (1 - F(observed - threshold))
+
+  The GPD is F(y) = 1 - (1 + shape*y/scale)^(-1/shape), estimated by the method of
+  Zhang and Stephens (2009).  Goodness of fit is assessed by an Anderson-Darling
+  statistic, whose p-value is obtained by a parametric bootstrap.  If the fit is
+  rejected, the number of exceedances is lowered by 10 and we try again.
+
+  References:
+  Knijnenburg, T. A., et al. (2009) Fewer permutations, more accurate P-values. Bioinformatics 25, i161-i168.
+  Zhang, J., & Stephens, M. A. (2009) A New and Efficient Estimation Method for the Generalized Pareto Distribution. Technometrics 51, 316-325.
+ */
+
+struct gpd_fit
+{
+  //True if a fit passed the goodness-of-fit test
+  bool ok;
+  double shape,scale,threshold;
+  //Number of exceedances used for the fit
+  unsigned nexceed;
+  //Bootstrap p-value of the Anderson-Darling statistic for the accepted (or last attempted) fit
+  double gof_p;
+  gpd_fit();
+};
+
+//Zhang-Stephens estimate from positive exceedances sorted in ascending order.  Returns false if no estimate exists.
+bool gpd_estimate( const std::vector<double> & y, double & shape, double & scale );
+
+double gpd_cdf( const double & y, const double & shape, const double & scale );
+
+//Anderson-Darling statistic of exceedances (ascending order) against a fitted GPD
+double gpd_anderson_darling( const std::vector<double> & y, const double & shape, const double & scale );
+
+/*
+  Fit the tail.  largest contains the largest permuted values in decreasing order.
+  It may be a complete permutation distribution or just its top (see perm_summary).
+  At most max_exceed exceedances are used.
+ */
+gpd_fit gpd_tail_fit( const std::vector<double> & largest,
+		      const unsigned & max_exceed = 250,
+		      const unsigned & gof_reps = 100,
+		      const double & gof_alpha = 0.05,
+		      const unsigned & seed = 0 );
+
+//Tail p-value of observed, given a fit from nperms permutations
+double gpd_tail_p( const gpd_fit & fit, const double & observed, const double & nperms );
+
+#endif
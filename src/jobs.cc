@@ -0,0 +1,120 @@
+#include <Rcpp.h>
+#include <perm_job.hpp>
+#include <string>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+namespace {
+  const char * JOB_STAT_NAMES[POWER_NSTATS] = { "esm", "calpha", "MB.general", "MB.recessive", "MB.dominant", "LL.collapse" };
+
+  perm_job * get_job( XPtr<perm_job> job, const char * caller )
+  {
+    //A handle restored from a saved session no longer points to a job
+    if( job.get() == 0 )
+      {
+	stop( string(caller) + ": the job no longer exists" );
+      }
+    return job.get();
+  }
+}
+
+//' Start a permutation test of all burden statistics on background threads
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param nperms Number of permutations to perform
+//' @param seed Random number seed
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param nthreads Number of threads to run the permutations on
+//' @param esm_fisher see allBurdenStats
+//' @return A handle to the job, which is returned at once, while the permutations run.
+//' @details Use permJobProgress or burden.job.status to see how far the job has got and the p-values so far, permJobCancel to stop it,
+//' and burden.job.wait to wait for it.  The job is cancelled if the handle is garbage-collected.  Permutation i uses the same random
+//' number stream as permutation i of allBurdenStatsPermShard with the same seed, so a job that finishes gives the same p-values
+//' as allBurdenStatsPermShard(ccdata,ccstatus,nperms,1,1,seed,...).  R's random number generator is not used.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' job = allBurdenStatsPermAsync(rec.ccdata$genos[,which(keep==1)],status,1000,101,50,5e-2)
+//' res = burden.job.wait(job)
+// [[Rcpp::export]]
+XPtr<perm_job> allBurdenStatsPermAsync( const IntegerMatrix & ccdata,
+					const IntegerVector & ccstatus,
+					const unsigned & nperms,
+					const unsigned & seed,
+					const unsigned & esm_K,
+					const double & LLc_maf,
+					const bool & LLc_maf_control = true,
+					const bool normalize_calpha = false,
+					const bool simplecount_calpha = false,
+					const unsigned & nthreads = 1,
+					const bool esm_fisher = false )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("allBurdenStatsPermAsync: length(ccstatus) != nrow(ccdata)");
+    }
+  power_params par;
+  par.nperms = nperms;
+  par.esm_K = esm_K;
+  par.LLc_maf = LLc_maf;
+  par.LLc_maf_control = LLc_maf_control;
+  par.normalize_calpha = normalize_calpha;
+  par.simplecount_calpha = simplecount_calpha;
+  par.esm_fisher = esm_fisher;
+  par.seed = seed;
+  perm_job * job = new perm_job( sparse_genotypes(ccdata.begin(),ccdata.nrow(),ccdata.ncol()),
+				 vector<int>(ccstatus.begin(),ccstatus.end()), par );
+  string error;
+  if( !job->start(nthreads,error) )
+    {
+      delete job;
+      stop("allBurdenStatsPermAsync: " + error);
+    }
+  return XPtr<perm_job>(job,true);
+}
+
+//' Progress of a background permutation test
+//' @param job A handle returned by allBurdenStatsPermAsync
+//' @return A list with the observed statistics, the number of permutations requested (nperms) and finished (done), the number of
+//' finished permutations whose value is >= the observed value of each statistic (nexceed), the seconds since the job started (elapsed),
+//' the permutations finished per second, and whether the job is still running and whether it was cancelled.
+//' @details The counts are always those of a whole number of blocks of permutations, so nexceed/done is a Monte-carlo p-value.
+//' burden.job.status adds these p-values and their confidence intervals.
+// [[Rcpp::export]]
+List permJobProgress( XPtr<perm_job> job )
+{
+  perm_job_status s = get_job(job,"permJobProgress")->progress();
+  CharacterVector names(JOB_STAT_NAMES,JOB_STAT_NAMES+POWER_NSTATS);
+  NumericVector stat(s.observed.begin(),s.observed.end()),nexceed(s.nexceed.begin(),s.nexceed.end());
+  stat.names() = names;
+  nexceed.names() = names;
+  return List::create( Named("statistic") = stat,
+		       Named("nperms") = s.nperms,
+		       Named("done") = s.done,
+		       Named("nexceed") = nexceed,
+		       Named("elapsed") = s.elapsed,
+		       Named("perms.per.second") = ( s.elapsed > 0. ) ? double(s.done)/s.elapsed : NA_REAL,
+		       Named("running") = s.running,
+		       Named("cancelled") = s.cancelled );
+}
+
+//' Cancel a background permutation test
+//' @param job A handle returned by allBurdenStatsPermAsync
+//' @param wait If TRUE, return once the job's threads have stopped
+//' @details Each thread finishes the block of permutations it is working on, and the permutations finished so far remain
+//' available from permJobProgress.
+// [[Rcpp::export]]
+void permJobCancel( XPtr<perm_job> job,
+		    const bool & wait = true )
+{
+  perm_job * j = get_job(job,"permJobCancel");
+  j->cancel();
+  if( wait ) j->wait();
+}
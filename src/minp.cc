@@ -0,0 +1,55 @@
+#include <minp.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+  //P(X >= x), from the non-NaN values of a distribution, sorted in ascending order
+  inline double upper_p( const vector<double> & sorted, const double & x, const unsigned & nperms )
+  {
+    if( x != x ) return 1.;
+    return double( sorted.end() - lower_bound(sorted.begin(),sorted.end(),x) )/double(nperms);
+  }
+}
+
+minp_result minp_omnibus( const vector< vector<double> > & permdist,
+			  const vector<double> & observed )
+{
+  if( permdist.size() != observed.size() || permdist.empty() )
+    {
+      throw invalid_argument("minp_omnibus: need one permutation distribution per observed statistic");
+    }
+  const unsigned nstats = permdist.size(), nperms = permdist[0].size();
+  minp_result rv;
+  rv.pvalues.resize(nstats);
+  vector<double> perm_minp(nperms,1.),sorted;
+  for( unsigned j = 0 ; j < nstats ; ++j )
+    {
+      if( permdist[j].size() != nperms )
+	{
+	  throw invalid_argument("minp_omnibus: all statistics must have the same number of permutations");
+	}
+      sorted.clear();
+      for( vector<double>::const_iterator itr = permdist[j].begin() ; itr != permdist[j].end() ; ++itr )
+	{
+	  //NaN would break the ordering.  As a permuted value it has p = 1, and it never counts as >= anything.
+	  if( *itr == *itr ) sorted.push_back(*itr);
+	}
+      sort(sorted.begin(),sorted.end());
+      rv.pvalues[j] = upper_p(sorted,observed[j],nperms);
+      for( unsigned i = 0 ; i < nperms ; ++i )
+	{
+	  perm_minp[i] = min( perm_minp[i], upper_p(sorted,permdist[j][i],nperms) );
+	}
+    }
+  rv.minp = *min_element(rv.pvalues.begin(),rv.pvalues.end());
+  rv.p = double( count_if(perm_minp.begin(),perm_minp.end(),[&](double p){ return p <= rv.minp; }) )/double(nperms);
+  sort(perm_minp.begin(),perm_minp.end());
+  rv.adjusted.resize(nstats);
+  for( unsigned j = 0 ; j < nstats ; ++j )
+    {
+      rv.adjusted[j] = double( upper_bound(perm_minp.begin(),perm_minp.end(),rv.pvalues[j]) - perm_minp.begin() )/double(nperms);
+    }
+  return rv;
+}
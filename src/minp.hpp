@@ -0,0 +1,37 @@
+#ifndef __MINP_HPP__
+#define __MINP_HPP__
+
+#include <vector>
+
+/*
+  Min-p omnibus test across several statistics computed on the same permutations.
+
+  permdist[j][i] is the value of statistic j in permutation i.  Every permuted value
+  is converted to a p-value by its rank within its own permutation distribution,
+  p_ij = #{k : permdist[j][k] >= permdist[j][i]}/nperms, and the same is done for
+  the observed statistics.  The omnibus statistic is the smallest p-value over
+  statistics, and its p-value is the fraction of permutations whose smallest p-value
+  is <= the observed one.  Because all statistics share each permutation, this
+  accounts for the correlation among them (Westfall & Young 1993).
+
+  The same permutations give single-step adjusted p-values for each statistic,
+  the fraction of permutations whose smallest p-value is <= that statistic's
+  p-value.  These control the family-wise error rate over the statistics, which
+  may also be one statistic in many regions scored on the same permutations.
+
+  NaN statistics are given a p-value of 1.
+ */
+struct minp_result
+{
+  //Per-statistic p-values of the observed data
+  std::vector<double> pvalues;
+  //min(pvalues), and its permutation p-value
+  double minp,p;
+  //Single-step min-p adjusted pvalues
+  std::vector<double> adjusted;
+};
+
+minp_result minp_omnibus( const std::vector< std::vector<double> > & permdist,
+			  const std::vector<double> & observed );
+
+#endif
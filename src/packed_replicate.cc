@@ -0,0 +1,193 @@
+#include <packed_replicate.hpp>
+#include <fstream>
+#include <algorithm>
+#include <stdint.h>
+
+using namespace std;
+
+namespace {
+  const char MAGIC[4] = { 'B','R','D','N' };
+  const uint32_t VERSION = 1;
+
+  void put_u32( ostream & o, const uint32_t & x )
+  {
+    char b[4] = { char(x & 0xFF), char((x>>8) & 0xFF), char((x>>16) & 0xFF), char((x>>24) & 0xFF) };
+    o.write(b,4);
+  }
+
+  bool get_u32( istream & in, uint32_t & x )
+  {
+    unsigned char b[4];
+    if( !in.read(reinterpret_cast<char *>(b),4) ) return false;
+    x = uint32_t(b[0]) | (uint32_t(b[1])<<8) | (uint32_t(b[2])<<16) | (uint32_t(b[3])<<24);
+    return true;
+  }
+}
+
+bool packed_replicate_write( const string & file,
+			     const int * genos,
+			     const unsigned & nrow,
+			     const unsigned & ncol,
+			     const int * status,
+			     string & error )
+{
+  for( unsigned i = 0 ; i < nrow ; ++i )
+    {
+      if( status[i] != 0 && status[i] != 1 )
+	{
+	  error = "phenotype label other than 0 or 1 encountered";
+	  return false;
+	}
+    }
+  ofstream o(file.c_str(),ios::out|ios::binary|ios::trunc);
+  if( !o )
+    {
+      error = "could not open " + file + " for writing";
+      return false;
+    }
+  o.write(MAGIC,4);
+  put_u32(o,VERSION);
+  put_u32(o,nrow);
+  put_u32(o,ncol);
+  for( unsigned i = 0 ; i < nrow ; ++i ) o.put( char(status[i]) );
+  const unsigned nbytes = (nrow+3)/4;
+  vector<char> packed(nbytes);
+  for( unsigned j = 0 ; j < ncol ; ++j )
+    {
+      fill(packed.begin(),packed.end(),0);
+      for( unsigned i = 0 ; i < nrow ; ++i, ++genos )
+	{
+	  if( *genos < 0 || *genos > 2 )
+	    {
+	      error = "genotype value other than 0, 1, or 2 encountered";
+	      return false;
+	    }
+	  packed[i/4] |= char( *genos << (2*(i%4)) );
+	}
+      if( nbytes ) o.write(&packed[0],nbytes);
+    }
+  o.close();
+  if( !o )
+    {
+      error = "error writing " + file;
+      return false;
+    }
+  return true;
+}
+
+namespace {
+  //Reads the file header and phenotype labels, leaving in at the first marker
+  bool read_header( istream & in,
+		    const string & file,
+		    unsigned & nrow,
+		    unsigned & ncol,
+		    vector<int> & status,
+		    string & error )
+  {
+    if( !in )
+      {
+	error = "could not open " + file;
+	return false;
+      }
+    char magic[4];
+    uint32_t version,nr,nc;
+    if( !in.read(magic,4) || !equal(magic,magic+4,MAGIC) ||
+	!get_u32(in,version) || !get_u32(in,nr) || !get_u32(in,nc) )
+      {
+	error = file + " is not a packed replicate file";
+	return false;
+      }
+    if( version != VERSION )
+      {
+	error = file + " has an unsupported format version";
+	return false;
+      }
+    nrow = nr;
+    ncol = nc;
+    status.resize(nrow);
+    for( unsigned i = 0 ; i < nrow ; ++i )
+      {
+	int c = in.get();
+	if( c != 0 && c != 1 )
+	  {
+	    error = file + " is truncated or has an invalid phenotype label";
+	    return false;
+	  }
+	status[i] = c;
+      }
+    return true;
+  }
+
+  //Unpacks the next ncol markers of nrow individuals
+  bool read_columns( istream & in,
+		     const string & file,
+		     const unsigned & nrow,
+		     const unsigned & ncol,
+		     vector<int> & genos,
+		     string & error )
+  {
+    const unsigned nbytes = (nrow+3)/4;
+    vector<unsigned char> packed(nbytes);
+    genos.resize(size_t(nrow)*size_t(ncol));
+    vector<int>::iterator g = genos.begin();
+    for( unsigned j = 0 ; j < ncol ; ++j )
+      {
+	if( nbytes && !in.read(reinterpret_cast<char *>(&packed[0]),nbytes) )
+	  {
+	    error = file + " is truncated";
+	    return false;
+	  }
+	for( unsigned i = 0 ; i < nrow ; ++i, ++g )
+	  {
+	    *g = (packed[i/4] >> (2*(i%4))) & 3;
+	    if( *g == 3 )
+	      {
+		error = file + " contains an invalid genotype code";
+		return false;
+	      }
+	  }
+      }
+    return true;
+  }
+}
+
+bool packed_replicate_read( const string & file,
+			    vector<int> & genos,
+			    unsigned & nrow,
+			    unsigned & ncol,
+			    vector<int> & status,
+			    string & error )
+{
+  ifstream in(file.c_str(),ios::in|ios::binary);
+  return read_header(in,file,nrow,ncol,status,error) && read_columns(in,file,nrow,ncol,genos,error);
+}
+
+bool packed_replicate_header( const string & file,
+			      unsigned & nrow,
+			      unsigned & ncol,
+			      vector<int> & status,
+			      string & error )
+{
+  ifstream in(file.c_str(),ios::in|ios::binary);
+  return read_header(in,file,nrow,ncol,status,error);
+}
+
+bool packed_replicate_read_columns( const string & file,
+				    const unsigned & first,
+				    const unsigned & ncol,
+				    vector<int> & genos,
+				    string & error )
+{
+  ifstream in(file.c_str(),ios::in|ios::binary);
+  unsigned nr,nc;
+  vector<int> status;
+  if( !read_header(in,file,nr,nc,status,error) ) return false;
+  if( first > nc || ncol > nc - first )
+    {
+      error = file + " has fewer markers than requested";
+      return false;
+    }
+  //Every marker takes the same number of bytes, so the first one wanted can be sought directly
+  in.seekg( streamoff(size_t(first)*size_t((nr+3)/4)), ios::cur );
+  return read_columns(in,file,nr,ncol,genos,error);
+}
@@ -0,0 +1,54 @@
+#ifndef __PACKED_REPLICATE_HPP__
+#define __PACKED_REPLICATE_HPP__
+
+#include <string>
+#include <vector>
+
+/*
+  Binary file holding one case/control replicate, for power studies that keep
+  their simulated data on disk.  The layout is:
+
+  bytes 0-3    "BRDN"
+  bytes 4-15   format version (1), number of individuals, number of markers,
+               each an unsigned 32-bit integer, least significant byte first
+  next nrow    one byte per individual: 0 = control, 1 = case
+  the rest     genotypes (0, 1, or 2), one marker at a time, packed four per
+               byte in two bits each (individual i is in bits 2*(i%4) and up).
+               Every marker starts on a new byte.
+
+  Both functions return false and describe the problem in error if they fail.
+  They do not use R, so files may be read from worker threads.
+ */
+bool packed_replicate_write( const std::string & file,
+			     const int * genos,
+			     const unsigned & nrow,
+			     const unsigned & ncol,
+			     const int * status,
+			     std::string & error );
+
+bool packed_replicate_read( const std::string & file,
+			    std::vector<int> & genos,
+			    unsigned & nrow,
+			    unsigned & ncol,
+			    std::vector<int> & status,
+			    std::string & error );
+
+//Reads only the numbers of individuals and markers, and the phenotype labels
+bool packed_replicate_header( const std::string & file,
+			      unsigned & nrow,
+			      unsigned & ncol,
+			      std::vector<int> & status,
+			      std::string & error );
+
+/*
+  Reads markers first through first+ncol-1 (counting from 0) into genos, which is
+  column-major with one row per individual.  Only those markers are read, so a
+  large file may be processed a block of markers at a time.
+ */
+bool packed_replicate_read_columns( const std::string & file,
+				    const unsigned & first,
+				    const unsigned & ncol,
+				    std::vector<int> & genos,
+				    std::string & error );
+
+#endif
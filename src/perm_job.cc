@@ -0,0 +1,145 @@
+#include <perm_job.hpp>
+#include <algorithm>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace {
+  double now()
+  {
+    timeval t;
+    gettimeofday(&t,0);
+    return double(t.tv_sec) + 1e-6*double(t.tv_usec);
+  }
+}
+
+perm_job::perm_job( const sparse_genotypes & __G, const vector<int> & __status, const power_params & __par ) :
+  G(__G),patterns(G),status(__status),par(__par),observed(vector<double>()),threads(vector<pthread_t>()),
+  next(0),done(0),nexceed(vector<unsigned>(POWER_NSTATS,0)),cancelled(0),nrunning(0),
+  start_time(0.),stop_time(0.)
+{
+  pthread_mutex_init(&lock,0);
+}
+
+perm_job::~perm_job()
+{
+  cancel();
+  wait();
+  pthread_mutex_destroy(&lock);
+}
+
+bool perm_job::start( const unsigned & nthreads, string & error )
+{
+  if( !observed.empty() )
+    {
+      error = "the job has already been started";
+      return false;
+    }
+  if( status.size() != G.nrow )
+    {
+      error = "the number of phenotype labels does not match the number of individuals";
+      return false;
+    }
+  if( G.nrow == 0 )
+    {
+      error = "there are no individuals";
+      return false;
+    }
+  for( vector<int>::const_iterator itr = G.geno.begin() ; itr != G.geno.end() ; ++itr )
+    {
+      if( *itr < 0 || *itr > 2 )
+	{
+	  error = "genotype value other than 0, 1, or 2 encountered";
+	  return false;
+	}
+    }
+  //The observed statistics are a test with no permutations
+  power_params obs_par = par;
+  obs_par.nperms = 0;
+  vector<double> p;
+  if( !burden_sparse_test(G,&status[0],0,obs_par,observed,p,error) ) return false;
+
+  start_time = stop_time = now();
+  pthread_mutex_lock(&lock);
+  for( unsigned t = 0 ; t < max(nthreads,1u) ; ++t )
+    {
+      pthread_t tid;
+      if( pthread_create(&tid,0,perm_job::run,this) != 0 ) break;
+      threads.push_back(tid);
+      ++nrunning;
+    }
+  pthread_mutex_unlock(&lock);
+  if( threads.empty() )
+    {
+      error = "could not start a thread";
+      return false;
+    }
+  return true;
+}
+
+void * perm_job::run( void * job )
+{
+  static_cast<perm_job *>(job)->work();
+  return 0;
+}
+
+void perm_job::work()
+{
+  vector<unsigned> counts(POWER_NSTATS);
+  vector<int> labels;
+  for(;;)
+    {
+      pthread_mutex_lock(&lock);
+      if( cancelled || next >= par.nperms )
+	{
+	  if( --nrunning == 0 ) stop_time = now();
+	  pthread_mutex_unlock(&lock);
+	  return;
+	}
+      const unsigned first = next, B = min(POWER_PERM_BLOCK,par.nperms-next);
+      next += B;
+      pthread_mutex_unlock(&lock);
+
+      fill(counts.begin(),counts.end(),0u);
+      burden_perm_block(G,&status[0],0,first,B,par,observed,counts,labels,&patterns);
+
+      pthread_mutex_lock(&lock);
+      done += B;
+      for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	{
+	  nexceed[j] += counts[j];
+	}
+      pthread_mutex_unlock(&lock);
+    }
+}
+
+void perm_job::cancel()
+{
+  pthread_mutex_lock(&lock);
+  cancelled = 1;
+  pthread_mutex_unlock(&lock);
+}
+
+void perm_job::wait()
+{
+  for( vector<pthread_t>::iterator itr = threads.begin() ; itr != threads.end() ; ++itr )
+    {
+      pthread_join(*itr,0);
+    }
+  threads.clear();
+}
+
+perm_job_status perm_job::progress() const
+{
+  perm_job_status rv;
+  pthread_mutex_lock(&lock);
+  rv.observed = observed;
+  rv.nperms = par.nperms;
+  rv.done = done;
+  rv.nexceed = nexceed;
+  rv.running = ( nrunning > 0 );
+  rv.cancelled = ( cancelled != 0 );
+  rv.elapsed = ( rv.running ? now() : stop_time ) - start_time;
+  pthread_mutex_unlock(&lock);
+  return rv;
+}
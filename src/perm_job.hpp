@@ -0,0 +1,72 @@
+#ifndef __PERM_JOB_HPP__
+#define __PERM_JOB_HPP__
+
+#include <power_study.hpp>
+#include <sparse_genotypes.hpp>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/*
+  A permutation test of all burden statistics that runs on background threads.
+
+  Worker threads take blocks of POWER_PERM_BLOCK permutations in turn and add
+  their exceedance counts to the job's totals, so the counts may be read at any
+  time, and are always those of a whole number of finished blocks.  Permutation
+  i uses stream i of the seed, as in allBurdenStatsPermShard, so a job that runs
+  to completion gives the same p-values as one shard of the same nperms and seed.
+
+  Nothing here uses R.  Cancelling a job lets each thread finish its current
+  block; the destructor cancels the job and waits for its threads.
+ */
+
+struct perm_job_status
+{
+  //Statistics of the unpermuted data, in allBurdenStats order
+  std::vector<double> observed;
+  //Permutations requested and finished
+  unsigned nperms,done;
+  //For each statistic, the number of finished permutations whose value is >= observed
+  std::vector<unsigned> nexceed;
+  //Seconds since the job started, up to when it stopped if it has
+  double elapsed;
+  bool running,cancelled;
+};
+
+class perm_job
+{
+private:
+  sparse_genotypes G;
+  //Carrier patterns of G, shared by all threads
+  site_patterns patterns;
+  std::vector<int> status;
+  power_params par;
+  std::vector<double> observed;
+  std::vector<pthread_t> threads;
+  mutable pthread_mutex_t lock;
+  //Next permutation to be handed out, and number finished
+  unsigned next,done;
+  std::vector<unsigned> nexceed;
+  volatile int cancelled;
+  unsigned nrunning;
+  double start_time,stop_time;
+  static void * run( void * job );
+  void work();
+  perm_job( const perm_job & );
+  perm_job & operator=( const perm_job & );
+public:
+  perm_job( const sparse_genotypes & __G, const std::vector<int> & __status, const power_params & __par );
+  ~perm_job();
+  /*
+    Calculates the observed statistics and starts nthreads threads.
+    Returns false, and sets error, if the data are not valid or no thread could be started.
+  */
+  bool start( const unsigned & nthreads, std::string & error );
+  //Asks the threads to stop after their current blocks
+  void cancel();
+  //Blocks until every thread has stopped
+  void wait();
+  perm_job_status progress() const;
+};
+
+#endif
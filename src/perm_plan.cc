@@ -0,0 +1,193 @@
+#include <perm_plan.hpp>
+#include <perm_rng.hpp>
+#include <algorithm>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+  const char MAGIC[4] = { 'B','R','P','P' };
+  const uint32_t VERSION = 1;
+  const size_t HEADER_SIZE = 28;
+
+  void put_u32( unsigned char * b, const uint32_t & x )
+  {
+    b[0] = x & 0xFF;
+    b[1] = (x>>8) & 0xFF;
+    b[2] = (x>>16) & 0xFF;
+    b[3] = (x>>24) & 0xFF;
+  }
+
+  uint32_t get_u32( const unsigned char * b )
+  {
+    return uint32_t(b[0]) | (uint32_t(b[1])<<8) | (uint32_t(b[2])<<16) | (uint32_t(b[3])<<24);
+  }
+}
+
+perm_plan::perm_plan() : owned(vector<unsigned char>()),bits(0),map(0),maplen(0),
+			 n(0),ncases(0),nperms(0),seed(0)
+{
+}
+
+perm_plan::~perm_plan()
+{
+  release();
+}
+
+void perm_plan::release()
+{
+#ifndef _WIN32
+  if( map ) munmap(map,maplen);
+#endif
+  map = 0;
+  maplen = 0;
+  vector<unsigned char>().swap(owned);
+  bits = 0;
+}
+
+unsigned perm_plan::stride() const
+{
+  return (n+7)/8;
+}
+
+bool perm_plan::mapped() const
+{
+  return map != 0;
+}
+
+bool perm_plan::generate( const int * status, const unsigned & __n, const unsigned & __nperms,
+			  const uint64_t & __seed, string & error )
+{
+  unsigned nc = 0;
+  for( unsigned k = 0 ; k < __n ; ++k )
+    {
+      if( status[k] != 0 && status[k] != 1 )
+	{
+	  error = "phenotype label other than 0 or 1 encountered";
+	  return false;
+	}
+      nc += status[k];
+    }
+  release();
+  n = __n;
+  ncases = nc;
+  nperms = __nperms;
+  seed = __seed;
+  const unsigned s = stride();
+  owned.assign(size_t(s)*size_t(nperms),0);
+  vector<int> labels;
+  for( unsigned i = 0 ; i < nperms ; ++i )
+    {
+      labels.assign(status,status+n);
+      perm_rng rng(seed,i);
+      perm_shuffle(labels.begin(),labels.end(),rng);
+      unsigned char * b = &owned[0] + size_t(i)*s;
+      for( unsigned k = 0 ; k < n ; ++k )
+	{
+	  if( labels[k] ) b[k/8] |= (unsigned char)(1u << (k%8));
+	}
+    }
+  bits = owned.empty() ? 0 : &owned[0];
+  return true;
+}
+
+bool perm_plan::write( const string & file, string & error ) const
+{
+  ofstream o(file.c_str(),ios::out|ios::binary|ios::trunc);
+  if( !o )
+    {
+      error = "could not open " + file + " for writing";
+      return false;
+    }
+  unsigned char header[HEADER_SIZE];
+  copy(MAGIC,MAGIC+4,header);
+  put_u32(header+4,VERSION);
+  put_u32(header+8,n);
+  put_u32(header+12,ncases);
+  put_u32(header+16,nperms);
+  put_u32(header+20,uint32_t(seed & 0xFFFFFFFF));
+  put_u32(header+24,uint32_t(seed >> 32));
+  o.write(reinterpret_cast<const char *>(header),HEADER_SIZE);
+  if( nperms > 0 ) o.write(reinterpret_cast<const char *>(bits),streamsize(size_t(stride())*size_t(nperms)));
+  if( !o )
+    {
+      error = "error writing " + file;
+      return false;
+    }
+  return true;
+}
+
+bool perm_plan::open( const string & file, string & error )
+{
+  release();
+  ifstream in(file.c_str(),ios::in|ios::binary);
+  unsigned char header[HEADER_SIZE];
+  if( !in || !in.read(reinterpret_cast<char *>(header),HEADER_SIZE) || !equal(MAGIC,MAGIC+4,header) )
+    {
+      error = file + " is not a permutation plan";
+      return false;
+    }
+  if( get_u32(header+4) != VERSION )
+    {
+      error = file + " has an unsupported format version";
+      return false;
+    }
+  n = get_u32(header+8);
+  ncases = get_u32(header+12);
+  nperms = get_u32(header+16);
+  seed = uint64_t(get_u32(header+20)) | (uint64_t(get_u32(header+24)) << 32);
+  const size_t nbytes = size_t(stride())*size_t(nperms);
+  in.seekg(0,ios::end);
+  if( size_t(in.tellg()) != HEADER_SIZE + nbytes || ncases > n )
+    {
+      error = file + " is truncated or corrupt";
+      return false;
+    }
+  if( nbytes == 0 ) return true;
+#ifndef _WIN32
+  const int fd = ::open(file.c_str(),O_RDONLY);
+  if( fd >= 0 )
+    {
+      void * m = mmap(0,HEADER_SIZE+nbytes,PROT_READ,MAP_SHARED,fd,0);
+      close(fd);
+      if( m != MAP_FAILED )
+	{
+	  map = m;
+	  maplen = HEADER_SIZE+nbytes;
+	  bits = static_cast<const unsigned char *>(m) + HEADER_SIZE;
+	  return true;
+	}
+    }
+#endif
+  //No memory mapping, so read the permutations in
+  owned.resize(nbytes);
+  in.clear();
+  in.seekg(HEADER_SIZE,ios::beg);
+  if( !in.read(reinterpret_cast<char *>(&owned[0]),streamsize(nbytes)) )
+    {
+      error = "error reading " + file;
+      return false;
+    }
+  bits = &owned[0];
+  return true;
+}
+
+const unsigned char * perm_plan::packed( const unsigned & i ) const
+{
+  return bits + size_t(i)*stride();
+}
+
+void perm_plan::labels( const unsigned & i, int * out ) const
+{
+  const unsigned char * b = packed(i);
+  for( unsigned k = 0 ; k < n ; ++k )
+    {
+      out[k] = ( b[k/8] >> (k%8) ) & 1;
+    }
+}
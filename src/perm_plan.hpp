@@ -0,0 +1,61 @@
+#ifndef __PERM_PLAN_HPP__
+#define __PERM_PLAN_HPP__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*
+  A stored set of permuted phenotype labels, which any number of statistics
+  and regions can use as the same null draws.
+
+  Permutation i is the labels shuffled by perm_rng(seed,i), which is the same
+  as permutation i+1 of allBurdenStatsPermShard with the same labels and seed.
+  Since every permutation of labels with the same numbers of cases and controls
+  is equally likely, a plan may be used with any labels that have the same number
+  of individuals and cases as the ones it was made from.
+
+  Each permutation is stored as one bit per individual (1 = case), so a plan
+  for 10^5 permutations of 2000 individuals takes 25 MB.  The file layout is:
+
+  bytes 0-3    "BRPP"
+  bytes 4-27   format version (1), number of individuals, number of cases,
+               number of permutations, and the low and high 32 bits of the
+               seed, each an unsigned 32-bit integer, least significant byte first
+  the rest     the permutations in order, each in (n+7)/8 bytes, with
+               individual k in bit k%8 of byte k/8
+
+  open() maps the file into memory where the system allows it, so that a large
+  plan shared by many processes is only held once.  Nothing here uses R.
+ */
+class perm_plan
+{
+private:
+  std::vector<unsigned char> owned;
+  const unsigned char * bits;
+  void * map;
+  size_t maplen;
+  void release();
+  perm_plan( const perm_plan & );
+  perm_plan & operator=( const perm_plan & );
+public:
+  unsigned n,ncases,nperms;
+  uint64_t seed;
+  perm_plan();
+  ~perm_plan();
+  //Bytes per permutation
+  unsigned stride() const;
+  //Returns false, and sets error, if the labels are not all 0 or 1.
+  bool generate( const int * status, const unsigned & __n, const unsigned & __nperms,
+		 const uint64_t & __seed, std::string & error );
+  bool write( const std::string & file, std::string & error ) const;
+  bool open( const std::string & file, std::string & error );
+  //True if the permutations are mapped from a file rather than held in memory
+  bool mapped() const;
+  //Labels of permutation i, counting from 0
+  void labels( const unsigned & i, int * out ) const;
+  //Permutation i as stored, in stride() bytes: individual k is a case if bit k%8 of byte k/8 is set
+  const unsigned char * packed( const unsigned & i ) const;
+};
+
+#endif
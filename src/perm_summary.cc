@@ -0,0 +1,46 @@
+#include <perm_summary.hpp>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+perm_summary::perm_summary( const double & __observed,
+			    const unsigned & __tail_size ) : tail_size(__tail_size),
+							     tail(vector<double>()),
+							     observed(__observed),
+							     nperms(0.),nexceed(0.),sum(0.),sumsq(0.)
+{
+  tail.reserve(tail_size);
+}
+
+void perm_summary::operator()(const double & permval)
+{
+  nperms += 1.;
+  if( permval >= observed ) nexceed += 1.;
+  sum += permval;
+  sumsq += permval*permval;
+  if( tail_size ) add_tail(permval);
+}
+
+void perm_summary::add_tail(const double & permval)
+{
+  if( permval != permval ) return; //NaN has no place in an ordered tail
+  if( tail.size() < tail_size )
+    {
+      tail.push_back(permval);
+      push_heap(tail.begin(),tail.end(),greater<double>());
+    }
+  else if ( permval > tail.front() )
+    {
+      pop_heap(tail.begin(),tail.end(),greater<double>());
+      tail.back() = permval;
+      push_heap(tail.begin(),tail.end(),greater<double>());
+    }
+}
+
+vector<double> perm_summary::tail_values() const
+{
+  vector<double> rv(tail.begin(),tail.end());
+  sort(rv.begin(),rv.end(),greater<double>());
+  return rv;
+}
@@ -0,0 +1,34 @@
+#ifndef __PERM_SUMMARY_HPP__
+#define __PERM_SUMMARY_HPP__
+
+#include <vector>
+
+/*
+  Running summary of a permutation distribution relative to an observed statistic.
+
+  Rather than storing every permuted value, we keep what is needed for a p-value
+  and a Z-score: the number of permutations, the number of permuted values >= the
+  observed value, and the first two moments.  Optionally, the tail_size largest
+  permuted values are kept, too.
+
+  All of these are additive over disjoint sets of permutations, which is what
+  lets shards of one permutation run be merged (see merge_perm_shards in R/perms.R).
+ */
+class perm_summary
+{
+private:
+  unsigned tail_size;
+  //min-heap holding the largest permuted values seen so far
+  std::vector<double> tail;
+  void add_tail(const double & permval);
+public:
+  double observed;
+  double nperms,nexceed,sum,sumsq;
+  perm_summary( const double & __observed, const unsigned & __tail_size = 0 );
+  //Add one permuted value
+  void operator()(const double & permval);
+  //The retained tail values, sorted from largest to smallest
+  std::vector<double> tail_values() const;
+};
+
+#endif
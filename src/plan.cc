@@ -0,0 +1,190 @@
+#include <Rcpp.h>
+#include <perm_plan.hpp>
+#include <stat_multitrait.hpp>
+#include <sparse_genotypes.hpp>
+#include <power_study.hpp>
+#include <validate.hpp>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+//' Make a permutation plan
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param nperms Number of permutations
+//' @param seed Random number seed
+//' @param file If not empty, the plan is also written to this file.  By convention, the extension is .brpp
+//' @return A handle to the plan
+//' @details A plan stores nperms permutations of ccstatus, one bit per individual, so that many statistics and regions can be
+//' scored on the same null draws.  It may be used with any labels that have the same numbers of individuals and cases.  Permutation i
+//' is the same as permutation i of allBurdenStatsPermShard with the same labels and seed.  Plans are used by allBurdenStatsPermPlan,
+//' esm_perm_plan, cAlpha_perm_plan, MB_perm_plan, LLcollapse_perm_plan, burden.plan.fwer, and permPlanLabels, whose labels may be
+//' given to any other statistic.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' plan = permPlan(status,100,101)
+//' L = permPlanLabels(plan,1,10)
+//' calpha.perms = apply(L,2,function(s) cAlpha(rec.ccdata$genos,s))
+// [[Rcpp::export]]
+XPtr<perm_plan> permPlan( const IntegerVector & ccstatus,
+			  const unsigned & nperms,
+			  const unsigned & seed,
+			  const std::string & file = "" )
+{
+  perm_plan * plan = new perm_plan();
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  string error;
+  if( !plan->generate(status.empty() ? 0 : &status[0],status.size(),nperms,seed,error) ||
+      ( !file.empty() && !plan->write(file,error) ) )
+    {
+      delete plan;
+      stop("permPlan: " + error);
+    }
+  return XPtr<perm_plan>(plan,true);
+}
+
+//' Open a permutation plan file
+//' @param file A file written by permPlan or permPlanWrite
+//' @return A handle to the plan
+//' @details Where the system allows it, the file is mapped into memory rather than read, so a large plan that is shared by several
+//' R processes on one machine is only held in memory once.
+// [[Rcpp::export]]
+XPtr<perm_plan> permPlanOpen( const std::string & file )
+{
+  perm_plan * plan = new perm_plan();
+  string error;
+  if( !plan->open(file,error) )
+    {
+      delete plan;
+      stop("permPlanOpen: " + error);
+    }
+  return XPtr<perm_plan>(plan,true);
+}
+
+//' Write a permutation plan to a file
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param file The file name
+// [[Rcpp::export]]
+void permPlanWrite( XPtr<perm_plan> plan,
+		    const std::string & file )
+{
+  string error;
+  if( !validate_plan(plan,"permPlanWrite")->write(file,error) )
+    {
+      stop("permPlanWrite: " + error);
+    }
+}
+
+//' Describe a permutation plan
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @return A list with the numbers of individuals, cases, and permutations, the seed, and whether the plan is mapped from a file.
+// [[Rcpp::export]]
+List permPlanInfo( XPtr<perm_plan> plan )
+{
+  const perm_plan * p = validate_plan(plan,"permPlanInfo");
+  return List::create( Named("n") = p->n,
+		       Named("ncases") = p->ncases,
+		       Named("nperms") = p->nperms,
+		       Named("seed") = double(p->seed),
+		       Named("mapped") = p->mapped() );
+}
+
+//' Permuted labels from a permutation plan
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param first The first permutation, counting from 1
+//' @param last The last permutation.  If 0, the last permutation of the plan.
+//' @return A matrix with one row per individual and one column per permutation, holding the permuted labels.
+// [[Rcpp::export]]
+IntegerMatrix permPlanLabels( XPtr<perm_plan> plan,
+			      const unsigned & first = 1,
+			      const unsigned & last = 0 )
+{
+  const perm_plan * p = validate_plan(plan,"permPlanLabels");
+  const unsigned l = ( last == 0 ) ? p->nperms : last;
+  if( first < 1 || l > p->nperms || first > l )
+    {
+      stop("permPlanLabels: the permutations must be between 1 and the number in the plan, and first <= last");
+    }
+  IntegerMatrix rv(p->n,l-first+1);
+  for( unsigned i = first-1 ; i < l ; ++i )
+    {
+      p->labels(i,rv.begin() + size_t(i-first+1)*p->n);
+    }
+  return rv;
+}
+
+//' Permutation distributions of all burden statistics from a permutation plan
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param esm_fisher see allBurdenStats
+//' @return A list of permutation distributions, the same as allBurdenStatsPerm, with one value per permutation of the plan.
+//' @details ccstatus is only used to check that the plan has the same numbers of individuals and cases.  Every call with the same plan
+//' uses the same permuted labels, so the distributions of different statistics and of different regions may be compared
+//' permutation by permutation, as burden_minp and burden.plan.fwer do.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,5e-2,0.8)
+//' plan = permPlan(status,100,101)
+//' perms = allBurdenStatsPermPlan(rec.ccdata$genos[,which(keep==1)],status,plan,50,5e-2)
+// [[Rcpp::export]]
+List allBurdenStatsPermPlan( const IntegerMatrix & ccdata,
+			     const IntegerVector & ccstatus,
+			     XPtr<perm_plan> plan,
+			     const unsigned & esm_K,
+			     const double & LLc_maf,
+			     const bool & LLc_maf_control = true,
+			     const bool normalize_calpha = false,
+			     const bool simplecount_calpha = false,
+			     const bool esm_fisher = false )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("allBurdenStatsPermPlan: length(ccstatus) != nrow(ccdata)");
+    }
+  const perm_plan * p = validate_plan(plan,ccstatus,"allBurdenStatsPermPlan");
+  const sparse_genotypes G = validate_genotypes(ccdata,"allBurdenStatsPermPlan");
+  const unsigned n = p->n, nperms = p->nperms;
+  const site_patterns patterns(G);
+  NumericVector esm_p(nperms),
+    calpha_p(nperms),
+    MBg_p(nperms),
+    MBr_p(nperms),
+    MBd_p(nperms),
+    LLc_p(nperms);
+  vector<int> labels;
+  multitrait_values v;
+  for( unsigned first = 0 ; first < nperms ; first += POWER_PERM_BLOCK )
+    {
+      const unsigned B = min(POWER_PERM_BLOCK,nperms-first);
+      labels.resize(size_t(n)*B);
+      for( unsigned b = 0 ; b < B ; ++b )
+	{
+	  p->labels(first+b,&labels[0] + size_t(b)*n);
+	}
+      stat_multitrait(&labels[0],n,B)(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,v,&patterns,esm_fisher);
+      copy(v.esm.begin(),v.esm.end(),esm_p.begin()+first);
+      copy(v.calpha.begin(),v.calpha.end(),calpha_p.begin()+first);
+      copy(v.MBg.begin(),v.MBg.end(),MBg_p.begin()+first);
+      copy(v.MBr.begin(),v.MBr.end(),MBr_p.begin()+first);
+      copy(v.MBd.begin(),v.MBd.end(),MBd_p.begin()+first);
+      copy(v.LLc.begin(),v.LLc.end(),LLc_p.begin()+first);
+      checkUserInterrupt();
+    }
+  return List::create( Named("esm.permdist") = esm_p,
+		       Named("calpha.permdist") = calpha_p,
+		       Named("MB.general.permdist") = MBg_p,
+		       Named("MB.recessive.permdist") = MBr_p,
+		       Named("MB.dominant.permdist") = MBd_p,
+		       Named("LL.collapse.permdist") = LLc_p
+		       );
+}
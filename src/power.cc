@@ -0,0 +1,240 @@
+#include <Rcpp.h>
+#include <power_study.hpp>
+#include <packed_replicate.hpp>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace Rcpp;
+using namespace std;
+
+namespace {
+  const char * POWER_STAT_NAMES[POWER_NSTATS] = { "esm", "calpha", "MB.general", "MB.recessive", "MB.dominant", "LL.collapse" };
+
+  /*
+    Copies an R replicate into rep.  A replicate is a list with a genotype
+    matrix (genos) and either a vector of labels (status), or the numbers of
+    controls and cases (ncontrols and ncases), in which case the controls are
+    the first rows of genos, like rec.ccdata.
+  */
+  void copy_replicate( const List & x, power_replicate & rep )
+  {
+    IntegerMatrix genos = as<IntegerMatrix>(x["genos"]);
+    rep.nrow = genos.nrow();
+    rep.ncol = genos.ncol();
+    rep.genos.assign(genos.begin(),genos.end());
+    if( x.containsElementNamed("status") )
+      {
+	IntegerVector status = as<IntegerVector>(x["status"]);
+	rep.status.assign(status.begin(),status.end());
+      }
+    else
+      {
+	const unsigned ncontrols = as<unsigned>(x["ncontrols"]), ncases = as<unsigned>(x["ncases"]);
+	rep.status.assign(ncontrols,0);
+	rep.status.resize(ncontrols+ncases,1);
+      }
+  }
+}
+
+//' Write a case/control replicate to a packed binary file
+//' @param file The file name.  By convention, the extension is .brdn
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @details Genotypes are stored in two bits each.  Directories of such files may be used as the replicates of power.study,
+//' which reads them in parallel without going through R.
+//' @examples
+//' data(rec.ccdata)
+//' status = c( rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' f = tempfile(fileext=".brdn")
+//' write_packed_replicate(f,rec.ccdata$genos,status)
+//' x = read_packed_replicate(f)
+// [[Rcpp::export]]
+void write_packed_replicate( const std::string & file,
+			     const IntegerMatrix & ccdata,
+			     const IntegerVector & ccstatus )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("write_packed_replicate: length(ccstatus) != nrow(ccdata)");
+    }
+  string error;
+  if( !packed_replicate_write(file,ccdata.begin(),ccdata.nrow(),ccdata.ncol(),ccstatus.begin(),error) )
+    {
+      stop("write_packed_replicate: " + error);
+    }
+}
+
+//' Read a case/control replicate from a packed binary file
+//' @param file The file name
+//' @return A list with the genotype matrix (genos) and the phenotype labels (status)
+//' @seealso write_packed_replicate
+// [[Rcpp::export]]
+List read_packed_replicate( const std::string & file )
+{
+  power_replicate rep;
+  string error;
+  if( !packed_replicate_read(file,rep.genos,rep.nrow,rep.ncol,rep.status,error) )
+    {
+      stop("read_packed_replicate: " + error);
+    }
+  IntegerMatrix genos(rep.nrow,rep.ncol);
+  copy(rep.genos.begin(),rep.genos.end(),genos.begin());
+  return List::create( Named("genos") = genos,
+		       Named("status") = IntegerVector(rep.status.begin(),rep.status.end()) );
+}
+
+//' Power of all burden statistics, estimated from simulated replicates
+//' @param source The replicates.  Either a list of replicates, a character vector of packed replicate files, or a function.  See Details.
+//' @param nreps The number of replicates.  For a list or files, 0 means all of them.
+//' @param nperms Number of permutations per replicate
+//' @param alpha The significance levels at which to count rejections
+//' @param seed Random number seed for the permutations
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param nthreads The number of threads used to process replicates
+//' @param progress If TRUE, report progress after each batch of replicates
+//' @param esm_fisher see allBurdenStats
+//' @return A data frame with one row per statistic and significance level, giving the number of rejections (p-value <= alpha),
+//' the number of replicates with a p-value, and the rejection rate (power).
+//' @details A replicate is a list with a genotype matrix (genos) and either a vector of phenotype labels (status), or the numbers of
+//' controls and cases (ncontrols and ncases), in which case the controls are the first rows of genos, as in rec.ccdata.  source may be
+//' a list of such replicates, the names of files written by write_packed_replicate, or a function that takes a replicate index (from 1 to nreps)
+//' and returns a replicate.
+//'
+//' Replicates are processed in batches.  Lists and functions are read by the main thread, and files by the worker threads.  The p-values are
+//' Monte-carlo p-values, as in allBurdenStats.p.perm.  Permutations are generated from seed and the index of the replicate, so the results
+//' do not depend on nthreads.  R's random number generator is not used, except by a user-supplied function.
+//' A statistic whose value is not a number for a replicate is not counted in that replicate.
+//' Threads are only available if the package was built with OpenMP.
+// [[Rcpp::export]]
+DataFrame powerStudy( SEXP source,
+		      const unsigned & nreps,
+		      const unsigned & nperms,
+		      const NumericVector & alpha,
+		      const unsigned & seed,
+		      const unsigned & esm_K,
+		      const double & LLc_maf,
+		      const bool & LLc_maf_control = true,
+		      const bool & normalize_calpha = false,
+		      const bool & simplecount_calpha = false,
+		      const unsigned & nthreads = 1,
+		      const bool & progress = false,
+		      const bool & esm_fisher = false )
+{
+  const bool is_sampler = Rf_isFunction(source), is_files = Rf_isString(source);
+  if( !is_sampler && !is_files && !Rf_isNewList(source) )
+    {
+      stop("powerStudy: source must be a list, a character vector of file names, or a function");
+    }
+  const unsigned nsource = (is_sampler) ? nreps : unsigned(Rf_length(source));
+  const unsigned N = (nreps == 0 || nreps > nsource) ? nsource : nreps;
+  if( N == 0 )
+    {
+      stop("powerStudy: no replicates");
+    }
+  power_params par;
+  par.nperms = nperms;
+  par.esm_K = esm_K;
+  par.LLc_maf = LLc_maf;
+  par.LLc_maf_control = LLc_maf_control;
+  par.normalize_calpha = normalize_calpha;
+  par.simplecount_calpha = simplecount_calpha;
+  par.esm_fisher = esm_fisher;
+  par.seed = seed;
+
+  const unsigned nthr = max(1u,nthreads), batch = 16*nthr, na = alpha.size();
+  vector<unsigned> rejections(POWER_NSTATS*na,0),tested(POWER_NSTATS,0);
+  vector<power_replicate> reps(batch);
+  vector< vector<double> > pvals(batch);
+  vector<string> errors(batch);
+  vector<char> ok(batch);
+
+  for( unsigned first = 0 ; first < N ; first += batch )
+    {
+      const unsigned last = min(N,first+batch);
+      //R is only used from this thread
+      for( unsigned r = first ; r < last ; ++r )
+	{
+	  if( is_sampler )
+	    {
+	      Function sampler(source);
+	      copy_replicate( as<List>(sampler(r+1)), reps[r-first] );
+	    }
+	  else if( !is_files )
+	    {
+	      copy_replicate( as<List>(VECTOR_ELT(source,r)), reps[r-first] );
+	    }
+	}
+      vector<string> files;
+      if( is_files )
+	{
+	  for( unsigned r = first ; r < last ; ++r ) files.push_back( string(CHAR(STRING_ELT(source,r))) );
+	}
+
+      const int nb = int(last-first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nthr)
+#endif
+      for( int b = 0 ; b < nb ; ++b )
+	{
+	  power_replicate & rep = reps[b];
+	  errors[b].clear();
+	  ok[b] = ( !is_files || packed_replicate_read(files[b],rep.genos,rep.nrow,rep.ncol,rep.status,errors[b]) ) &&
+	    power_replicate_p(rep,first+b,par,pvals[b],errors[b]);
+	}
+
+      for( unsigned b = 0 ; b < last-first ; ++b )
+	{
+	  if( !ok[b] )
+	    {
+	      ostringstream o;
+	      o << "powerStudy: replicate " << (first+b+1) << ": " << errors[b];
+	      stop(o.str());
+	    }
+	  for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+	    {
+	      const double p = pvals[b][j];
+	      if( p != p ) continue;
+	      ++tested[j];
+	      for( unsigned a = 0 ; a < na ; ++a )
+		{
+		  rejections[j*na+a] += ( p <= alpha[a] );
+		}
+	    }
+	}
+      if( progress )
+	{
+	  Rcout << "powerStudy: " << last << " of " << N << " replicates\n";
+	}
+      checkUserInterrupt();
+    }
+
+  CharacterVector statistic(POWER_NSTATS*na);
+  NumericVector alphas(POWER_NSTATS*na),nrejected(POWER_NSTATS*na),ntested(POWER_NSTATS*na),power(POWER_NSTATS*na);
+  for( unsigned j = 0 ; j < POWER_NSTATS ; ++j )
+    {
+      for( unsigned a = 0 ; a < na ; ++a )
+	{
+	  const unsigned k = j*na+a;
+	  statistic[k] = POWER_STAT_NAMES[j];
+	  alphas[k] = alpha[a];
+	  nrejected[k] = rejections[k];
+	  ntested[k] = tested[j];
+	  power[k] = double(rejections[k])/double(tested[j]);
+	}
+    }
+  return DataFrame::create( Named("statistic") = statistic,
+			    Named("alpha") = alphas,
+			    Named("rejections") = nrejected,
+			    Named("replicates") = ntested,
+			    Named("power") = power,
+			    Named("stringsAsFactors") = false );
+}
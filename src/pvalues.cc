@@ -0,0 +1,125 @@
+#include <Rcpp.h>
+#include <gpd_tail.hpp>
+#include <minp.hpp>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+//' Permutation p-value with a generalized Pareto approximation to the tail
+//' @param permdist Permuted values of a statistic.  This may be the entire permutation distribution, or only its largest values (see Details).
+//' @param stat The observed value of the statistic
+//' @param nperms The total number of permutations.  If 0, length(permdist) is used.
+//' @param min_exceed If at least this many permuted values are >= stat, the usual Monte-carlo p-value is returned.
+//' @param max_exceed The maximum number of exceedances used to fit the tail
+//' @param gof_reps Number of parametric bootstrap replicates for the goodness-of-fit test
+//' @param gof_alpha A tail fit is rejected if its goodness-of-fit p-value is <= gof_alpha
+//' @param seed Random number seed for the goodness-of-fit bootstrap
+//' @return A list with the p-value, the method used to obtain it ("empirical", "gpd", or "empirical.gpd.failed"), the GPD shape and scale,
+//' the threshold, the number of exceedances used for the fit, and the goodness-of-fit p-value.
+//' @details The Monte-carlo p-value of a statistic is imprecise when few permuted values exceed it, and is 0 when none do.
+//' In that case, a generalized Pareto distribution (GPD) is fit to the max_exceed largest permuted values, and the p-value
+//' is extrapolated from the fit.  The fit is accepted if an Anderson-Darling goodness-of-fit test is not rejected.  Otherwise,
+//' the number of exceedances is lowered in steps of 10 until a fit is accepted or fewer than 10 remain, in which case the
+//' Monte-carlo p-value is returned.  Only the largest max_exceed+1 permuted values are used, so permdist may be the "tail"
+//' kept by allBurdenStatsPermShard, with nperms set to the total number of permutations.
+//' A fitted tail with negative shape has a finite upper end point, and an observed value beyond that point gets a p-value of 0.
+//' @references Knijnenburg, T. A., Wessels, L. F. A., Reinders, M. J. T., & Shmulevich, I. (2009). Fewer permutations, more accurate P-values. Bioinformatics, 25(12), i161-i168. doi:10.1093/bioinformatics/btp211
+//' @references Zhang, J., & Stephens, M. A. (2009). A New and Efficient Estimation Method for the Generalized Pareto Distribution. Technometrics, 51(3), 316-325.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' stat = cAlpha(rec.ccdata$genos[,which(keep==1)],status)
+//' perms = cAlpha_perm(rec.ccdata$genos[,which(keep==1)],status,500)
+//' p = gpd_perm_p(perms,stat)
+// [[Rcpp::export]]
+List gpd_perm_p( const NumericVector & permdist,
+		 const double & stat,
+		 const double & nperms = 0,
+		 const unsigned & min_exceed = 10,
+		 const unsigned & max_exceed = 250,
+		 const unsigned & gof_reps = 100,
+		 const double & gof_alpha = 0.05,
+		 const unsigned & seed = 0 )
+{
+  const double N = (nperms > 0.) ? nperms : double(permdist.size());
+  vector<double> largest;
+  largest.reserve(permdist.size());
+  double nge = 0.;
+  for( NumericVector::const_iterator itr = permdist.begin() ; itr != permdist.end() ; ++itr )
+    {
+      if( *itr >= stat ) nge += 1.;
+      if( *itr == *itr ) largest.push_back(*itr); //skip NaN
+    }
+  gpd_fit fit;
+  string method = "empirical";
+  double p = nge/N;
+  if( nge < double(min_exceed) )
+    {
+      //only the top max_exceed+1 values are needed
+      unsigned ntop = min( unsigned(largest.size()), max_exceed+1 );
+      partial_sort(largest.begin(),largest.begin()+ntop,largest.end(),greater<double>());
+      largest.resize(ntop);
+      fit = gpd_tail_fit(largest,max_exceed,gof_reps,gof_alpha,seed);
+      if( fit.ok )
+	{
+	  p = gpd_tail_p(fit,stat,N);
+	  method = "gpd";
+	}
+      else
+	{
+	  method = "empirical.gpd.failed";
+	}
+    }
+  return List::create( Named("p.value") = p,
+		       Named("method") = method,
+		       Named("shape") = fit.shape,
+		       Named("scale") = fit.scale,
+		       Named("threshold") = fit.threshold,
+		       Named("n.exceed") = fit.nexceed,
+		       Named("gof.p.value") = fit.gof_p );
+}
+
+//' Min-p omnibus test across burden statistics
+//' @param permdist A matrix of permuted statistics, with one row per permutation and one column per statistic.  Each row must come from the same permuted labels.
+//' @param stat The observed statistics, in the same order as the columns of permdist
+//' @return A list containing the per-statistic permutation p-values of the observed data (p.values), the smallest of these (minp), the permutation p-value of minp (p.value),
+//' and the single-step min-p adjusted p-value of each statistic (adjusted.p.values).
+//' @details Each permuted value is converted to a p-value from its rank in its own column.  The smallest p-value in each row is the permuted
+//' min-p statistic, and p.value is the fraction of permutations whose min-p is <= the observed min-p.  Because every row uses the same
+//' permuted labels for all statistics, the correlation among statistics is accounted for, and p.value is corrected for testing several
+//' statistics without a second round of permutations.  The adjusted p-value of statistic j is the fraction of permutations whose min-p is <= the
+//' p-value of statistic j, which controls the family-wise error rate.  The columns may also be one statistic in many regions, scored on the
+//' same permuted labels (see permPlan), which gives gene-level family-wise error control.
+//' @references Westfall, P. H., & Young, S. S. (1993). Resampling-Based Multiple Testing: Examples and Methods for p-Value Adjustment. Wiley.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' stats = allBurdenStats(rec.ccdata$genos[,which(keep==1)],status,50,0.05)
+//' perms = allBurdenStatsPerm(rec.ccdata$genos[,which(keep==1)],status,100,50,0.05)
+//' omnibus = burden_minp( do.call(cbind,perms), unlist(stats[-2]) )
+// [[Rcpp::export]]
+List burden_minp( const NumericMatrix & permdist,
+		  const NumericVector & stat )
+{
+  if( permdist.ncol() != stat.size() )
+    {
+      stop("burden_minp: ncol(permdist) != length(stat)");
+    }
+  //matrix is column-major, so each statistic is a contiguous block
+  const unsigned nr = permdist.nrow();
+  vector< vector<double> > dists;
+  for( int j = 0 ; j < permdist.ncol() ; ++j )
+    {
+      dists.push_back( vector<double>( permdist.begin() + size_t(j)*nr, permdist.begin() + size_t(j+1)*nr ) );
+    }
+  minp_result r = minp_omnibus( dists, vector<double>(stat.begin(),stat.end()) );
+  return List::create( Named("p.values") = NumericVector(r.pvalues.begin(),r.pvalues.end()),
+		       Named("minp") = r.minp,
+		       Named("p.value") = r.p,
+		       Named("adjusted.p.values") = NumericVector(r.adjusted.begin(),r.adjusted.end()) );
+}
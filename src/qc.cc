@@ -0,0 +1,122 @@
+#include <Rcpp.h>
+#include <site_qc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace Rcpp;
+using namespace std;
+
+//' Quality control and filtering of sites in one pass
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele, and NA for a missing genotype.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param min_call_rate A site with a smaller fraction of non-missing genotypes will not be kept.
+//' @param minfreq A site with minor allele frequency in controls < minfreq will not be kept.
+//' @param maxfreq A site with minor allele frequency in controls >= maxfreq will not be kept.
+//' @param hwe_p A site whose p-value for Hardy-Weinberg equilibrium in controls is < hwe_p will not be kept.
+//' @param missing_p A site whose p-value for differential missingness between cases and controls is < missing_p will not be kept.
+//' @param rsq_cutoff Sites that pass the other filters are then pruned for LD, as in filter_sites: when comparing two sites,
+//' if the genotype correlation coefficient r^2 is > rsq_cutoff, only the first site will be kept.  The default does no pruning.
+//' @param nthreads The number of threads to use
+//' @return A list.  metrics is a data frame with one row per site, giving the call rate (call.rate), the minor allele frequency in
+//' called controls (control.maf) and in all called individuals (maf), the p-value of the exact test of Hardy-Weinberg equilibrium
+//' in controls (hwe.p), and the p-value of Fisher's exact test of missingness vs. case/control status (missing.p).  keep is a vector
+//' of 0 (not kept) and 1 (kept), as returned by filter_sites.
+//' @details All metrics of a site are calculated in a single pass over its genotypes, so the matrix is read once, rather than once
+//' per metric.  The LD pruning step reads the genotypes of the sites that survive in place, without copying them.
+//' Minor allele frequencies are those of the allele coded by the data, among called individuals.  The Hardy-Weinberg test is that
+//' of Wigginton, Cutler, and Abecasis (2005).  r^2 is calculated from the individuals called at both sites.
+//' Threads are only available if the package was built with OpenMP.
+//' @references Wigginton, J. E., Cutler, D. J., & Abecasis, G. R. (2005). A note on exact tests of Hardy-Weinberg equilibrium. The American Journal of Human Genetics, 76(5), 887-893.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' qc = siteQC(rec.ccdata$genos,status,min_call_rate=0.95,maxfreq=0.05,hwe_p=1e-6,rsq_cutoff=0.8)
+//' genos = rec.ccdata$genos[,which(qc$keep==1)]
+// [[Rcpp::export]]
+List siteQC( const IntegerMatrix & ccdata,
+	     const IntegerVector & ccstatus,
+	     const double & min_call_rate = 0.,
+	     const double & minfreq = 0.,
+	     const double & maxfreq = 1.,
+	     const double & hwe_p = 0.,
+	     const double & missing_p = 0.,
+	     const double & rsq_cutoff = 1.,
+	     const unsigned & nthreads = 1 )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("siteQC: length(ccstatus) != nrow(ccdata)");
+    }
+  const unsigned n = ccdata.nrow(), ncol = ccdata.ncol(), nthr = max(1u,nthreads);
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      if( status[i] != 0 && status[i] != 1 )
+	{
+	  stop("siteQC: phenotype label other than 0 or 1 encountered");
+	}
+    }
+  site_qc_thresholds t;
+  t.min_call_rate = min_call_rate;
+  t.minfreq = minfreq;
+  t.maxfreq = maxfreq;
+  t.min_hwe_p = hwe_p;
+  t.min_missing_p = missing_p;
+
+  const int * G = ccdata.begin();
+  vector<site_qc_metrics> metrics(ncol);
+  vector<int> keep(ncol,0);
+  //R is not used by the threads.  Each has its own engine, since engines keep tables of p-values.
+  bool ok = true;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthr)
+#endif
+  {
+    site_qc_engine qc(status.empty() ? 0 : &status[0],n);
+    bool thread_ok = true;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,64)
+#endif
+    for( int j = 0 ; j < int(ncol) ; ++j )
+      {
+	if( !qc(G + size_t(j)*n,metrics[j]) ) thread_ok = false;
+	else keep[j] = t.keep(metrics[j]);
+      }
+    if( !thread_ok )
+      {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+	ok = false;
+      }
+  }
+  if( !ok )
+    {
+      stop("siteQC: genotype value other than 0, 1, 2, or NA was encountered");
+    }
+  if( rsq_cutoff < 1. )
+    {
+      site_ld_prune(G,n,ncol,rsq_cutoff,nthr,keep);
+    }
+
+  NumericVector call_rate(ncol),control_maf(ncol),maf(ncol),hwe(ncol),missing(ncol);
+  for( unsigned j = 0 ; j < ncol ; ++j )
+    {
+      call_rate[j] = metrics[j].call_rate;
+      control_maf[j] = metrics[j].control_maf;
+      maf[j] = metrics[j].maf;
+      hwe[j] = pow(10.,-metrics[j].hwe_log10p);
+      missing[j] = pow(10.,-metrics[j].missing_log10p);
+    }
+  return List::create( Named("metrics") = DataFrame::create( Named("call.rate") = call_rate,
+							     Named("control.maf") = control_maf,
+							     Named("maf") = maf,
+							     Named("hwe.p") = hwe,
+							     Named("missing.p") = missing ),
+		       Named("keep") = IntegerVector(keep.begin(),keep.end()) );
+}
@@ -0,0 +1,127 @@
+#include <Rcpp.h>
+#include <window_scan.hpp>
+#include <sparse_genotypes.hpp>
+#include <validate.hpp>
+#include <randWrapper.hpp>
+#include <algorithm>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+//' Burden statistics in sliding windows
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param positions The position of each marker, in increasing order
+//' @param width The width of each window
+//' @param step The distance between the starts of consecutive windows
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param nperms Number of permutations used to obtain p-values for the maximum of each statistic over windows.  If 0, no permutations are done.
+//' @param esm_fisher see allBurdenStats
+//' @return A list.  windows is a data frame with the start, end, and number of markers of each window, and the statistics of allBurdenStats
+//' (except esm.K) for the markers in that window.  max contains the largest value of each statistic over all windows.  If nperms > 0, p.values contains
+//' the Monte-carlo estimate of P(max over windows of a permuted statistic >= the observed max), which corrects for scanning many overlapping windows.
+//' @details Windows are [start,start+width), for start = positions[1], positions[1]+step, and so on, up to the last position.  Windows containing no markers are skipped.
+//' Moving to the next window only adds the markers entering the window and removes those leaving it, so a scan costs about as much as a single call to
+//' allBurdenStats on all markers, rather than one call per window.  ESM_K uses the min(esm_K, number of markers) largest values in each window.
+//' The statistics for a window are those of allBurdenStats applied to the window's markers, except that c-alpha is accumulated as a running
+//' sum, and may differ in the last few bits.  Madsen-Browning scores are kept in fixed point with a resolution of 2^-30, so individuals whose scores
+//' differ by less than that may be ranked as tied.  A window containing a marker whose Madsen-Browning weight is not finite and positive
+//' (more control minor alleles than 2*ncases+1, as allBurdenStats counts them) gets NaN for the Madsen-Browning statistics.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' pos = 1:length(which(keep==1))
+//' scan = burdenScan(rec.ccdata$genos[,which(keep==1)],status,pos,20,10,5,0.05)
+// [[Rcpp::export]]
+List burdenScan( const IntegerMatrix & ccdata,
+		 const IntegerVector & ccstatus,
+		 const NumericVector & positions,
+		 const double & width,
+		 const double & step,
+		 const unsigned & esm_K,
+		 const double & LLc_maf,
+		 const bool & LLc_maf_control = true,
+		 const bool normalize_calpha = false,
+		 const bool simplecount_calpha = false,
+		 const unsigned & nperms = 0,
+		 const bool esm_fisher = false )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("burdenScan: length(ccstatus) != nrow(ccdata)");
+    }
+  if( positions.size() != ccdata.ncol() )
+    {
+      stop("burdenScan: length(positions) != ncol(ccdata)");
+    }
+  if( !(width > 0.) || !(step > 0.) )
+    {
+      stop("burdenScan: width and step must be > 0");
+    }
+  for( R_xlen_t j = 1 ; j < positions.size() ; ++j )
+    {
+      if( !(positions[j] >= positions[j-1]) )
+	{
+	  stop("burdenScan: positions must be sorted in increasing order");
+	}
+    }
+  validate_labels(ccstatus,"burdenScan");
+  const sparse_genotypes G = validate_genotypes(ccdata,"burdenScan");
+  vector<scan_window> windows = make_windows( vector<double>(positions.begin(),positions.end()), width, step );
+  window_scan scan(G,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,esm_fisher);
+  vector< vector<double> > per_window;
+  vector<double> maxima;
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  scan(&status[0],windows,&per_window,maxima);
+
+  NumericVector start(windows.size()),end(windows.size());
+  IntegerVector nsites(windows.size());
+  for( unsigned w = 0 ; w < windows.size() ; ++w )
+    {
+      start[w] = windows[w].start;
+      end[w] = windows[w].end;
+      nsites[w] = windows[w].last - windows[w].first;
+    }
+  DataFrame wdf = DataFrame::create( Named("start") = start,
+				     Named("end") = end,
+				     Named("nsites") = nsites,
+				     Named("esm.stat") = NumericVector(per_window[0].begin(),per_window[0].end()),
+				     Named("calpha.stat") = NumericVector(per_window[1].begin(),per_window[1].end()),
+				     Named("MB.general.stat") = NumericVector(per_window[2].begin(),per_window[2].end()),
+				     Named("MB.recessive.stat") = NumericVector(per_window[3].begin(),per_window[3].end()),
+				     Named("MB.dominant.stat") = NumericVector(per_window[4].begin(),per_window[4].end()),
+				     Named("LL.collapse.stat") = NumericVector(per_window[5].begin(),per_window[5].end()) );
+  CharacterVector statnames = CharacterVector::create("esm.stat","calpha.stat","MB.general.stat","MB.recessive.stat","MB.dominant.stat","LL.collapse.stat");
+  NumericVector mx(maxima.begin(),maxima.end());
+  mx.names() = statnames;
+  if( nperms == 0 )
+    {
+      return List::create( Named("windows") = wdf,
+			   Named("max") = mx );
+    }
+
+  RNGScope scope;
+  vector<double> nge(maxima.size(),0.),pmax;
+  for( unsigned i = 0 ; i < nperms ; ++i )
+    {
+      random_shuffle(status.begin(),status.end(),randWrapper);
+      scan(&status[0],windows,0,pmax);
+      for( unsigned s = 0 ; s < pmax.size() ; ++s )
+	{
+	  if( pmax[s] >= maxima[s] ) nge[s] += 1.;
+	}
+      checkUserInterrupt();
+    }
+  NumericVector p(nge.size());
+  for( unsigned s = 0 ; s < nge.size() ; ++s ) p[s] = nge[s]/double(nperms);
+  p.names() = statnames;
+  return List::create( Named("windows") = wdf,
+		       Named("max") = mx,
+		       Named("p.values") = p );
+}
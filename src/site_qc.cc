@@ -0,0 +1,183 @@
+#include <site_qc.hpp>
+#include <algorithm>
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace {
+  //Outcomes as likely as the observed one, up to rounding, count toward its p-value
+  const double HWE_REL_ERR = 1. + 1e-7;
+
+  unsigned count_cases( const int * status, const unsigned & n )
+  {
+    unsigned rv = 0;
+    for( unsigned i = 0 ; i < n ; ++i ) if( status[i] != 0 ) ++rv;
+    return rv;
+  }
+}
+
+site_qc_thresholds::site_qc_thresholds() : min_call_rate(0.),minfreq(0.),maxfreq(1.),min_hwe_p(0.),min_missing_p(0.)
+{
+}
+
+bool site_qc_thresholds::keep( const site_qc_metrics & m ) const
+{
+  return m.call_rate >= min_call_rate &&
+    m.control_maf >= minfreq && m.control_maf < maxfreq &&
+    pow(10.,-m.hwe_log10p) >= min_hwe_p &&
+    pow(10.,-m.missing_log10p) >= min_missing_p;
+}
+
+site_qc_engine::site_qc_engine( const int * __status, const unsigned & __n ) : status(__status),
+									     n(__n),
+									     ncases(count_cases(__status,__n)),
+									     missing_test(__n,ncases),
+									     logfact(vector<double>(size_t(__n)+1,0.)),
+									     hwe_cells(0),
+									     hwe_tables(map< pair<unsigned,unsigned>, vector<double> >())
+{
+  for( unsigned i = 2 ; i <= n ; ++i )
+    {
+      logfact[i] = logfact[i-1] + log(double(i));
+    }
+}
+
+void site_qc_engine::hwe_probabilities( const unsigned & N, const unsigned & rare,
+					vector<double> & d, double & total ) const
+{
+  //Heterozygotes have the parity of the rarer allele's count, and there are at most that many of them
+  d.resize(rare/2+1);
+  for( unsigned k = 0 ; k < d.size() ; ++k )
+    {
+      //k homozygotes for the rarer allele
+      const unsigned het = rare - 2*k, homc = N - het - k;
+      d[k] = double(het)*log(2.) - logfact[het] - logfact[k] - logfact[homc];
+    }
+  //Relative to the most likely outcome, as in fisher_exact
+  const double lmax = *max_element(d.begin(),d.end());
+  total = 0.;
+  for( unsigned k = 0 ; k < d.size() ; ++k )
+    {
+      d[k] = exp(d[k]-lmax);
+      total += d[k];
+    }
+}
+
+const vector<double> & site_qc_engine::hwe_table( const unsigned & N, const unsigned & minor )
+{
+  const unsigned rare = min(minor,2*N-minor);
+  vector<double> d;
+  double total;
+  hwe_probabilities(N,rare,d,total);
+  vector<double> sorted(d),cumsum(d.size());
+  sort(sorted.begin(),sorted.end());
+  double s = 0.;
+  for( unsigned k = 0 ; k < sorted.size() ; ++k )
+    {
+      s += sorted[k];
+      cumsum[k] = s;
+    }
+  vector<double> & rv = hwe_tables[make_pair(N,minor)];
+  rv.assign(rare+1,0.);
+  hwe_cells += rv.size();
+  for( unsigned k = 0 ; k < d.size() ; ++k )
+    {
+      const size_t i = size_t( upper_bound(sorted.begin(),sorted.end(),d[k]*HWE_REL_ERR) - sorted.begin() );
+      rv[rare-2*k] = max( 0., -log10( cumsum[i-1]/total ) );
+    }
+  return rv;
+}
+
+double site_qc_engine::hwe_log10p( const unsigned & N, const unsigned & minor, const unsigned & het )
+{
+  const unsigned rare = min(minor,2*N-minor);
+  if( het > rare || (rare-het)%2 ) return 0.;
+  map< pair<unsigned,unsigned>, vector<double> >::const_iterator itr = hwe_tables.find( make_pair(N,minor) );
+  if( itr != hwe_tables.end() ) return itr->second[het];
+  if( hwe_cells + rare + 1 <= FISHER_MAX_CELLS ) return hwe_table(N,minor)[het];
+
+  //No room to keep the table, so only p(het) is calculated
+  vector<double> d;
+  double total;
+  hwe_probabilities(N,rare,d,total);
+  const double dx = d[(rare-het)/2]*HWE_REL_ERR;
+  double s = 0.;
+  for( unsigned k = 0 ; k < d.size() ; ++k )
+    {
+      if( d[k] <= dx ) s += d[k];
+    }
+  return max( 0., -log10( s/total ) );
+}
+
+bool site_qc_engine::operator()( const int * g, site_qc_metrics & m )
+{
+  unsigned called = 0, dosage = 0, missing_cases = 0,
+    control_called = 0, control_dosage = 0, control_het = 0;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      const int x = g[i];
+      if( x < 0 )
+	{
+	  if( status[i] != 0 ) ++missing_cases;
+	  continue;
+	}
+      if( x > 2 ) return false;
+      ++called;
+      dosage += unsigned(x);
+      if( status[i] == 0 )
+	{
+	  ++control_called;
+	  control_dosage += unsigned(x);
+	  if( x == 1 ) ++control_het;
+	}
+    }
+  m.call_rate = (n) ? double(called)/double(n) : 0.;
+  m.control_maf = (control_called) ? double(control_dosage)/double(2*control_called) : 0.;
+  m.maf = (called) ? double(dosage)/double(2*called) : 0.;
+  m.hwe_log10p = (control_called) ? hwe_log10p(control_called,control_dosage,control_het) : 0.;
+  m.missing_log10p = missing_test.log10p(n - called,missing_cases);
+  return true;
+}
+
+double site_rsq( const int * x, const int * y, const unsigned & n )
+{
+  double m = 0.,sx = 0.,sy = 0.,sxx = 0.,syy = 0.,sxy = 0.;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      if( x[i] < 0 || y[i] < 0 ) continue;
+      const double a = double(x[i]), b = double(y[i]);
+      m += 1.;
+      sx += a;
+      sy += b;
+      sxx += a*a;
+      syy += b*b;
+      sxy += a*b;
+    }
+  if( m == 0. ) return 0.;
+  const double vx = sxx - sx*sx/m, vy = syy - sy*sy/m, cxy = sxy - sx*sy/m;
+  if( !(vx > 0.) || !(vy > 0.) ) return 0.;
+  return (cxy*cxy)/(vx*vy);
+}
+
+void site_ld_prune( const int * G, const unsigned & n, const unsigned & ncol,
+		    const double & rsq_cutoff, const unsigned & nthreads,
+		    vector<int> & keep )
+{
+  const int nc = int(ncol);
+  for( int i = 0 ; i + 1 < nc ; ++i )
+    {
+      if( !keep[i] ) continue;
+      const int * x = G + size_t(i)*n;
+      //Each j is only read and written by one thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) num_threads(max(1u,nthreads))
+#endif
+      for( int j = i+1 ; j < nc ; ++j )
+	{
+	  if( keep[j] && site_rsq(x,G + size_t(j)*n,n) > rsq_cutoff ) keep[j] = 0;
+	}
+    }
+}
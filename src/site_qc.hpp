@@ -0,0 +1,88 @@
+#ifndef __SITE_QC_HPP__
+#define __SITE_QC_HPP__
+
+#include <fisher_exact.hpp>
+#include <map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+/*
+  Per-site quality control, in one pass over each site's genotypes.
+
+  Genotypes are 0, 1, or 2 copies of the minor allele.  A negative value
+  (such as R's NA) is a missing genotype.  For each site, site_qc_engine
+  gets the call rate, the minor allele frequency in called controls and in
+  all called individuals, the exact test of Hardy-Weinberg equilibrium in
+  called controls (Wigginton, Cutler, and Abecasis 2005), and Fisher's exact
+  test of whether missingness differs between cases and controls.
+
+  Both tests have p-values that depend only on a few counts, so, as in
+  fisher_exact, the p-values of every outcome for given margins are
+  calculated the first time those margins are seen, and kept.  Like
+  fisher_exact, the HWE tables hold at most FISHER_MAX_CELLS p-values in
+  all; past that, the p-value of a site with new margins is calculated on
+  its own.  An engine is therefore not thread-safe; use one per thread.
+
+  No R objects are used.
+ */
+struct site_qc_metrics
+{
+  double call_rate,control_maf,maf;
+  //-log10 p-values
+  double hwe_log10p,missing_log10p;
+};
+
+struct site_qc_thresholds
+{
+  //A site is kept if call_rate >= min_call_rate, minfreq <= control_maf < maxfreq,
+  //and both p-values are >= the minimum p-values
+  double min_call_rate,minfreq,maxfreq,min_hwe_p,min_missing_p;
+  site_qc_thresholds();
+  bool keep( const site_qc_metrics & m ) const;
+};
+
+class site_qc_engine
+{
+private:
+  const int * status;
+  unsigned n,ncases;
+  fisher_exact missing_test;
+  std::vector<double> logfact;
+  size_t hwe_cells;
+  //(called controls, minor alleles) -> -log10 p-value for each number of heterozygotes
+  std::map< std::pair<unsigned,unsigned>, std::vector<double> > hwe_tables;
+  //Probabilities of k = 0 to rare/2 homozygotes for the rarer allele, relative to the largest, and their total
+  void hwe_probabilities( const unsigned & N, const unsigned & rare,
+			  std::vector<double> & d, double & total ) const;
+  const std::vector<double> & hwe_table( const unsigned & N, const unsigned & minor );
+  //-log10 p-value of het heterozygotes among N called controls with minor minor alleles
+  double hwe_log10p( const unsigned & N, const unsigned & minor, const unsigned & het );
+public:
+  //status has n labels, 0 = control, otherwise case
+  site_qc_engine( const int * __status, const unsigned & __n );
+  /*
+    Metrics of the site whose n genotypes start at g.
+    Returns false if a genotype is greater than 2.
+  */
+  bool operator()( const int * g, site_qc_metrics & m );
+};
+
+/*
+  r^2 between two sites, over the individuals called at both.  It is 0 if
+  either site does not vary among those individuals.
+*/
+double site_rsq( const int * x, const int * y, const unsigned & n );
+
+/*
+  LD pruning of the sites with keep[j] != 0, in place, as in filter_sites:
+  for each kept site i in order, a later kept site j with r^2 > rsq_cutoff
+  is no longer kept.  Site j's genotypes start at G + j*n, so the sites
+  are read where they are, and not copied.  The r^2 values for one site i
+  are calculated on nthreads threads, if OpenMP is available.
+*/
+void site_ld_prune( const int * G, const unsigned & n, const unsigned & ncol,
+		    const double & rsq_cutoff, const unsigned & nthreads,
+		    std::vector<int> & keep );
+
+#endif
@@ -0,0 +1,61 @@
+#include <Rcpp.h>
+#include <skat_test.hpp>
+#include <sparse_genotypes.hpp>
+#include <validate.hpp>
+#include <string>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+//' Variance-component (SKAT-style) test of a binary trait
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param weights A vector of weights to use for each marker, such as dbeta(MAF,1,25)
+//' @return A list with the statistic Q (statistic), its p-value (p.value), the approximation used for the p-value (method), and the
+//' positive eigenvalues of the weighted covariance of the per-marker scores (lambda).
+//' @details With p the proportion of cases, the score of marker j is U_j = sum_i g_ij*(y_i - p), and Q = sum_j (w_j*U_j)^2, which is
+//' the statistic of SKAT for a binary trait without covariates.  Under the null hypothesis, Q is a sum of independent chi-squared
+//' variables with one degree of freedom, weighted by lambda, the eigenvalues of W*Cov(U)*W.  Cov(U) is calculated from the genotypes of
+//' the individuals carrying each marker, so the cost depends on the numbers of markers and carriers, not on the square of the
+//' number of individuals.
+//'
+//' The p-value is from the saddlepoint approximation of Kuonen (1999), which is accurate to within a few percent (relative) well into
+//' the tail, and does not require permutations.  When Q is very close to its mean, where that approximation is unstable, a scaled
+//' chi-squared with the same mean and variance is used (method = "satterthwaite").  Eigenvalues are found by Jacobi rotations,
+//' whose cost grows as the cube of the number of markers, so the test is meant for genes or regions rather than whole chromosomes.
+//' @references Wu, M. C., Lee, S., Cai, T., Li, Y., Boehnke, M., & Lin, X. (2011). Rare-variant association testing for sequencing data with the sequence kernel association test. The American Journal of Human Genetics, 89(1), 82-93.
+//' @references Kuonen, D. (1999). Saddlepoint approximations for distributions of quadratic forms in normal variables. Biometrika, 86(4), 929-935.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' MAF = colSums(rec.ccdata$genos[,which(keep==1)])/(2*nrow(rec.ccdata$genos))
+//' rec.ccdata.skat = skatTest(rec.ccdata$genos[,which(keep==1)],status,dbeta(MAF,1,25))
+// [[Rcpp::export]]
+List skatTest( const IntegerMatrix & ccdata,
+	       const IntegerVector & ccstatus,
+	       const NumericVector & weights )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("skatTest: length(ccstatus) != nrow(ccdata)");
+    }
+  if( weights.size() != ccdata.ncol() )
+    {
+      stop("skatTest: length(weights) != ncol(ccdata)");
+    }
+  const sparse_genotypes G = validate_genotypes(ccdata,"skatTest");
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  vector<double> w(weights.begin(),weights.end());
+  skat_result rv;
+  string error;
+  if( !skat_test(G,status.empty() ? 0 : &status[0],w,rv,error) )
+    {
+      stop("skatTest: " + error);
+    }
+  return List::create( Named("statistic") = rv.Q,
+		       Named("p.value") = rv.p,
+		       Named("method") = rv.method,
+		       Named("lambda") = NumericVector(rv.lambda.begin(),rv.lambda.end()) );
+}
@@ -0,0 +1,209 @@
+#include <skat_test.hpp>
+#include <burden_math.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace std;
+
+namespace {
+  //Eigenvalues below this fraction of the mean positive eigenvalue are taken to be 0, as in the SKAT package
+  const double SKAT_EIGEN_TOL = 1e-5;
+  //Saddlepoints closer to 0 than this, in units of 1/(2*largest eigenvalue), use the Satterthwaite approximation
+  const double SKAT_SADDLE_TOL = 1e-4;
+  const unsigned JACOBI_MAX_SWEEPS = 100;
+
+  //P(Z > z) for a standard normal Z
+  double normal_upper( const double & z )
+  {
+    const double half = 0.5*burden_pchisq(z*z,1.,0,0);
+    return (z >= 0.) ? half : 1.-half;
+  }
+
+  //K(t), K'(t), and K''(t), the cumulant generating function of the mixture and its derivatives
+  void mixture_cgf( const vector<double> & lambda, const double & t,
+		    double & K, double & K1, double & K2 )
+  {
+    K = K1 = K2 = 0.;
+    for( unsigned k = 0 ; k < lambda.size() ; ++k )
+      {
+	const double d = 1. - 2.*lambda[k]*t;
+	K -= 0.5*log(d);
+	K1 += lambda[k]/d;
+	K2 += 2.*lambda[k]*lambda[k]/(d*d);
+      }
+  }
+}
+
+vector<double> symmetric_eigenvalues( vector<double> A, const unsigned & m )
+{
+  for( unsigned i = 0 ; i < m ; ++i )
+    for( unsigned j = 0 ; j < i ; ++j )
+      {
+	A[size_t(i)*m+j] = A[size_t(j)*m+i] = 0.5*(A[size_t(i)*m+j]+A[size_t(j)*m+i]);
+      }
+  double total = 0.;
+  for( size_t i = 0 ; i < A.size() ; ++i ) total += A[i]*A[i];
+  for( unsigned sweep = 0 ; sweep < JACOBI_MAX_SWEEPS ; ++sweep )
+    {
+      double off = 0.;
+      for( unsigned p = 0 ; p < m ; ++p )
+	for( unsigned q = p+1 ; q < m ; ++q ) off += 2.*A[size_t(p)*m+q]*A[size_t(p)*m+q];
+      if( !(off > 1e-28*total) ) break;
+      for( unsigned p = 0 ; p < m ; ++p )
+	{
+	  for( unsigned q = p+1 ; q < m ; ++q )
+	    {
+	      const double apq = A[size_t(p)*m+q];
+	      if( apq == 0. ) continue;
+	      const double theta = (A[size_t(q)*m+q]-A[size_t(p)*m+p])/(2.*apq);
+	      const double t = ((theta >= 0.) ? 1. : -1.)/(fabs(theta) + sqrt(theta*theta+1.));
+	      const double c = 1./sqrt(t*t+1.), s = t*c;
+	      A[size_t(p)*m+p] -= t*apq;
+	      A[size_t(q)*m+q] += t*apq;
+	      A[size_t(p)*m+q] = A[size_t(q)*m+p] = 0.;
+	      for( unsigned r = 0 ; r < m ; ++r )
+		{
+		  if( r == p || r == q ) continue;
+		  const double arp = A[size_t(r)*m+p], arq = A[size_t(r)*m+q];
+		  A[size_t(r)*m+p] = A[size_t(p)*m+r] = c*arp - s*arq;
+		  A[size_t(r)*m+q] = A[size_t(q)*m+r] = s*arp + c*arq;
+		}
+	    }
+	}
+    }
+  vector<double> rv(m);
+  for( unsigned i = 0 ; i < m ; ++i ) rv[i] = A[size_t(i)*m+i];
+  return rv;
+}
+
+double chisq_mixture_p( const vector<double> & lambda, const double & q, string & method )
+{
+  method = "saddlepoint";
+  if( lambda.empty() || !(q > 0.) ) return 1.;
+  const double lmax = *max_element(lambda.begin(),lambda.end());
+  double c1 = 0., c2 = 0.;
+  for( unsigned k = 0 ; k < lambda.size() ; ++k )
+    {
+      c1 += lambda[k];
+      c2 += lambda[k]*lambda[k];
+    }
+  //The saddlepoint solves K'(t) = q, for t < 1/(2*lmax).  K' is increasing, so bisect.
+  double hi = 0.5/lmax, lo = 0., K,K1,K2;
+  if( q < c1 )
+    {
+      lo = -0.5/lmax;
+      mixture_cgf(lambda,lo,K,K1,K2);
+      while( K1 > q )
+	{
+	  lo *= 2.;
+	  mixture_cgf(lambda,lo,K,K1,K2);
+	}
+      hi = 0.;
+    }
+  for( unsigned i = 0 ; i < 200 ; ++i )
+    {
+      const double mid = 0.5*(lo+hi);
+      if( mid == lo || mid == hi ) break;
+      mixture_cgf(lambda,mid,K,K1,K2);
+      if( K1 < q ) lo = mid;
+      else hi = mid;
+    }
+  const double t = 0.5*(lo+hi);
+  mixture_cgf(lambda,t,K,K1,K2);
+  const double w2 = 2.*(t*q - K);
+  if( fabs(t)*2.*lmax < SKAT_SADDLE_TOL || !(w2 > 0.) )
+    {
+      //Q is about a*chi-squared with d degrees of freedom, with the same mean and variance
+      method = "satterthwaite";
+      const double a = c2/c1, d = c1*c1/c2;
+      return burden_pchisq(q/a,d,0,0);
+    }
+  const double w = ((t > 0.) ? 1. : -1.)*sqrt(w2), v = t*sqrt(K2);
+  return min(1.,max(0.,normal_upper( w + log(v/w)/w )));
+}
+
+bool skat_test( const sparse_genotypes & G, const int * status,
+		const vector<double> & weights,
+		skat_result & rv, string & error )
+{
+  const unsigned n = G.nrow, m = G.ncol;
+  if( weights.size() != m )
+    {
+      error = "the number of weights is not the number of sites";
+      return false;
+    }
+  unsigned ncases = 0;
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      if( status[i] != 0 && status[i] != 1 )
+	{
+	  error = "phenotype label other than 0 or 1 encountered";
+	  return false;
+	}
+      ncases += unsigned(status[i]);
+    }
+  rv.Q = 0.;
+  rv.p = 1.;
+  rv.lambda.clear();
+  rv.method = "saddlepoint";
+  if( n == 0 || ncases == 0 || ncases == n || m == 0 ) return true;
+  const double p = double(ncases)/double(n);
+
+  //Scores, minor allele counts, and each individual's carried sites
+  vector<double> U(m,0.),s(m,0.);
+  vector<size_t> rowptr(size_t(n)+1,0);
+  for( size_t k = 0 ; k < G.rowind.size() ; ++k ) ++rowptr[G.rowind[k]+1];
+  for( unsigned i = 0 ; i < n ; ++i ) rowptr[i+1] += rowptr[i];
+  vector<unsigned> site(G.rowind.size());
+  vector<double> dose(G.rowind.size());
+  vector<size_t> next(rowptr.begin(),rowptr.end()-1);
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  const unsigned i = G.rowind[k];
+	  const double g = double(G.geno[k]);
+	  s[j] += g;
+	  U[j] += g*(double(status[i]) - p);
+	  site[next[i]] = j;
+	  dose[next[i]++] = g;
+	}
+    }
+  for( unsigned j = 0 ; j < m ; ++j ) rv.Q += weights[j]*weights[j]*U[j]*U[j];
+
+  //Upper triangle of G'G, one individual's carried sites at a time
+  vector<double> A(size_t(m)*m,0.);
+  for( unsigned i = 0 ; i < n ; ++i )
+    {
+      for( size_t a = rowptr[i] ; a < rowptr[i+1] ; ++a )
+	{
+	  double * row = &A[size_t(site[a])*m];
+	  for( size_t b = a ; b < rowptr[i+1] ; ++b ) row[site[b]] += dose[a]*dose[b];
+	}
+    }
+  const double v = p*(1.-p);
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      for( unsigned k = j ; k < m ; ++k )
+	{
+	  A[size_t(j)*m+k] = A[size_t(k)*m+j] = weights[j]*weights[k]*v*(A[size_t(j)*m+k] - s[j]*s[k]/double(n));
+	}
+    }
+  vector<double> lambda = symmetric_eigenvalues(A,m);
+  double sum = 0.;
+  unsigned npos = 0;
+  for( unsigned k = 0 ; k < m ; ++k )
+    {
+      if( lambda[k] > 0. )
+	{
+	  sum += lambda[k];
+	  ++npos;
+	}
+    }
+  const double cutoff = (npos) ? SKAT_EIGEN_TOL*sum/double(npos) : 0.;
+  for( unsigned k = 0 ; k < m ; ++k ) if( lambda[k] > cutoff ) rv.lambda.push_back(lambda[k]);
+  sort(rv.lambda.begin(),rv.lambda.end(),greater<double>());
+  rv.p = chisq_mixture_p(rv.lambda,rv.Q,rv.method);
+  return true;
+}
@@ -0,0 +1,52 @@
+#ifndef __SKAT_TEST_HPP__
+#define __SKAT_TEST_HPP__
+
+#include <sparse_genotypes.hpp>
+#include <string>
+#include <vector>
+
+/*
+  A variance-component (SKAT-style) test of a binary trait, without covariates,
+  calculated in site space.
+
+  With p the proportion of cases, the score of site j is
+  U_j = sum_i g_ij*(y_i - p), and the statistic is Q = sum_j (w_j*U_j)^2.
+  Under the null hypothesis, U has covariance p*(1-p)*(G'G - s*s'/n), where s
+  holds the sites' minor allele counts.  So Q is distributed as a sum of
+  lambda_k times independent chi-squared variables with one degree of freedom,
+  where the lambda_k are the eigenvalues of the m x m matrix W*Cov(U)*W.
+
+  G'G is made from each individual's carried sites, so the cost is the sum over
+  individuals of (sites carried)^2, plus the eigenvalues of an m x m matrix.
+  Nothing of size n x n is made.
+
+  No R objects are used.
+ */
+struct skat_result
+{
+  double Q,p;
+  //Positive eigenvalues of the weighted covariance of the scores, in decreasing order
+  std::vector<double> lambda;
+  //"saddlepoint", or "satterthwaite" when Q is too close to its mean for the saddlepoint approximation
+  std::string method;
+};
+
+/*
+  status holds G.nrow labels, 0 = control, 1 = case.  weights has one value per site.
+  Returns false, and sets error, if the data are not valid.
+*/
+bool skat_test( const sparse_genotypes & G, const int * status,
+		const std::vector<double> & weights,
+		skat_result & rv, std::string & error );
+
+//Eigenvalues of the symmetric m x m matrix A, by Jacobi rotations
+std::vector<double> symmetric_eigenvalues( std::vector<double> A, const unsigned & m );
+
+/*
+  P(sum_k lambda_k*X_k > q), the X_k independent chi-squared with one degree of
+  freedom and every lambda_k > 0, by the saddlepoint approximation of Kuonen (1999).
+  method receives the name of the approximation that was used.
+*/
+double chisq_mixture_p( const std::vector<double> & lambda, const double & q, std::string & method );
+
+#endif
@@ -2,8 +2,10 @@
 #include <stat_calculator.hpp>
 #include <randWrapper.hpp>
 #include <chisq.hpp>
+#include <validate.hpp>
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 using namespace Rcpp;
 using namespace std;
@@ -40,9 +42,10 @@ void stat_LLcollapse::operator()(const int & genotype,
   hasRare_site[ind++] = genotype;
 }
 
-Rcpp::List stat_LLcollapse::values()
+void stat_LLcollapse::table( unsigned & co, unsigned & cowo,
+			     unsigned & ca, unsigned & cawo ) const
 {
-  unsigned co=0,ca=0,cowo=0,cawo=0;
+  co=ca=cowo=cawo=0;
   for( unsigned i = 0 ; i < hasRare.size() ; ++i )
     {
       if( !status[i] ) //control
@@ -68,21 +71,40 @@ Rcpp::List stat_LLcollapse::values()
 	    }
 	}
     }
-  return List::create(Named("statistic") = chisq(co,cowo,co,cawo));
-  //double x = chisq(co,cowo,ca,cawo);
-    
-  // double a = co,b=ca,c=cowo,d=cawo;
-  // double __N = a+b+c+d;
-  // double inner = fabs(a*d-b*c);
-  // if ( inner == 0. ) 
-  //   {
-  //     List::create(Named("statistic") =0.);
-  //   }
-  // double rv = log10(__N)+2.*log10(fabs(inner)) - ( log10(a+b)+log10(c+d)+log10(b+d)+log10(a+c) );
-  // Rcerr << a << ' ' << b << ' ' << c << ' ' << d << ' ' << x <<' ' << std::pow(10,rv) << '\n';
-  // stop("stopping");
-  // return List::create(Named("statistic") = std::pow(10,rv));
-    
+}
+
+Rcpp::List stat_LLcollapse::values()
+{
+  unsigned co,cowo,ca,cawo;
+  table(co,cowo,ca,cawo);
+  return List::create(Named("statistic") = chisq(co,cowo,ca,cawo));
+}
+
+double stat_LLcollapse::exact_p() const
+{
+  if( mafc )
+    {
+      stop("stat_LLcollapse::exact_p: the null distribution is only fixed when MAF is calculated from all individuals");
+    }
+  unsigned co,cowo,ca,cawo;
+  table(co,cowo,ca,cawo);
+  /*
+    The set of carriers is fixed, so under permutation the number of carriers
+    among cases is hypergeometric.  We sum the probabilities of every table whose
+    statistic is at least as large as the observed one, allowing for rounding error
+    in the comparison the same way fisher.test does.
+  */
+  const unsigned ncarriers = co+ca, ncases = ca+cawo;
+  const double obs = chisq(co,cowo,ca,cawo);
+  double p = 0.;
+  for( unsigned x = (ncases > N-ncarriers) ? ncases-(N-ncarriers) : 0 ; x <= min(ncarriers,ncases) ; ++x )
+    {
+      if( chisq(ncarriers-x,ncontrols-(ncarriers-x),x,ncases-x) >= obs*(1.-1e-7) )
+	{
+	  p += R::dhyper(x,ncarriers,N-ncarriers,ncases,0);
+	}
+    }
+  return min(p,1.);
 }
 
 //' Calculates Li and Leal's collapsed variant statistic, v_c
@@ -90,7 +112,12 @@ Rcpp::List stat_LLcollapse::values()
 //' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
 //' @param maf Only consider variants whose minor allele frequencies are <= maf
 //' @param maf_controls  If true, calculate mafs from controls only.  Otherwise, use all individuals
-//' @return A chi-squared statistic based on a 2x2 table of the number of cases and controls with and without rare alleles. Yate's continuity correction is applied.
+//' @return A list.  The statistic element is a chi-squared statistic based on a 2x2 table of the number of cases and controls with and without rare alleles. Yate's continuity correction is applied.
+//' The p.value element is the exact permutation p-value of the statistic when maf_controls is FALSE, and NA otherwise.
+//' @details When maf_controls = FALSE, which sites are rare does not depend on the case/control labels, and neither does the set of individuals carrying
+//' a rare allele.  Permuting the labels only changes the number of carriers among cases, which has a hypergeometric distribution.  The p-value is then
+//' the probability of a table with a statistic at least as large as the observed one, which is exactly what an infinite number of calls to LLcollapse_perm
+//' would estimate.
 //' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
 //' @examples
 //' data(rec.ccdata)
@@ -103,7 +130,9 @@ List LLcollapse(const IntegerMatrix & ccdata,
 		const bool & maf_controls = false)
 {
   stat_LLcollapse f( maf, ccstatus, maf_controls );
-  return stat_calculator(ccdata,ccstatus,f);
+  List rv = stat_calculator(ccdata,ccstatus,f);
+  return List::create( Named("statistic") = rv["statistic"],
+		       Named("p.value") = (maf_controls) ? NA_REAL : f.exact_p() );
 }
 
 //' Permutation distribution of Li and Leal's collapsed variant statistic, v_c
@@ -113,6 +142,8 @@ List LLcollapse(const IntegerMatrix & ccdata,
 //' @param maf Only consider variants whose minor allele frequencies are <= maf
 //' @param maf_controls  If true, calculate mafs from controls only.  Otherwise, use all individuals
 //' @return The non-centrality parameter of a chi-squared distribution.  This is obtained using the proportion of controls and cases with rare variants.
+//' @details When maf_controls = FALSE, the carriers of rare alleles are found once, and each permutation only recounts them among cases.
+//' In that case, LLcollapse already returns the exact permutation p-value, and permutations are not needed.
 //' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
 //' @examples
 //' data(rec.ccdata)
@@ -129,11 +160,97 @@ NumericVector LLcollapse_perm(const IntegerMatrix & ccdata,
   RNGScope scope;
   IntegerVector status = clone(ccstatus);
 
+  if( !maf_controls )
+    {
+      //Carriers don't depend on labels, so find them once
+      stat_LLcollapse f( maf, ccstatus, maf_controls );
+      stat_calculator(ccdata,ccstatus,f);
+      const IntegerVector & carriers = f.carriers();
+      const unsigned ncarriers = count_if(carriers.begin(),carriers.end(),[](int c){ return c > 0; }),
+	ncases = count(ccstatus.begin(),ccstatus.end(),1),
+	ncontrols = ccstatus.size() - ncases;
+      for( unsigned i = 0 ; i < nperms ; ++i )
+	{
+	  random_shuffle(status.begin(),status.end(),randWrapper);
+	  unsigned ca = 0;
+	  for( R_xlen_t j = 0 ; j < status.size() ; ++j )
+	    {
+	      ca += (status[j]==1 && carriers[j]>0);
+	    }
+	  rv[i] = chisq(ncarriers-ca,ncontrols-(ncarriers-ca),ca,ncases-ca);
+	}
+      return rv;
+    }
+
   for( unsigned i = 0 ; i < nperms ; ++i )
     {
       random_shuffle(status.begin(),status.end(),randWrapper);
       stat_LLcollapse f( maf, status, maf_controls );
       rv[i] = as<double>( stat_calculator(ccdata,status,f)["statistic"] );
+      checkUserInterrupt();
+    }
+  return rv;
+}
+
+//' Permutation distribution of Li and Leal's collapsed variant statistic, v_c, from a permutation plan
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @param plan A handle returned by permPlan or permPlanOpen
+//' @param maf Only consider variants whose minor allele frequencies are <= maf
+//' @param maf_controls  If true, calculate mafs from controls only.  Otherwise, use all individuals
+//' @return The permuted statistics, the same as LLcollapse_perm, with one value per permutation of the plan.
+//' @details ccstatus is only used to check that the plan has the same numbers of individuals and cases, and, when maf_controls = FALSE,
+//' to find the carriers of rare alleles.  In that case, each permutation only tests the plan's bits for the carriers.
+//' @references Li, B., & Leal, S. (2008). Methods for detecting associations with rare variants for common diseases: application to analysis of sequence data. The American Journal of Human Genetics, 83(3), 311-321.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' plan = permPlan(status,100,101)
+//' LL.perm = LLcollapse_perm_plan(rec.ccdata$genos,status,plan,0.01)
+// [[Rcpp::export]]
+NumericVector LLcollapse_perm_plan(const IntegerMatrix & ccdata,
+				   const IntegerVector & ccstatus,
+				   XPtr<perm_plan> plan,
+				   const double & maf,
+				   const bool & maf_controls = false)
+{
+  const perm_plan * p = validate_plan(plan,ccstatus,"LLcollapse_perm_plan");
+  NumericVector rv(p->nperms);
+
+  if( !maf_controls )
+    {
+      //Carriers don't depend on labels, so find them once
+      stat_LLcollapse f( maf, ccstatus, maf_controls );
+      stat_calculator(ccdata,ccstatus,f);
+      const IntegerVector & carrier = f.carriers();
+      vector<unsigned> carriers;
+      for( R_xlen_t j = 0 ; j < carrier.size() ; ++j )
+	{
+	  if( carrier[j] > 0 ) carriers.push_back(j);
+	}
+      const unsigned ncarriers = carriers.size(),
+	ncases = p->ncases,
+	ncontrols = p->n - ncases;
+      for( unsigned i = 0 ; i < p->nperms ; ++i )
+	{
+	  const unsigned char * bits = p->packed(i);
+	  unsigned ca = 0;
+	  for( vector<unsigned>::const_iterator itr = carriers.begin() ; itr != carriers.end() ; ++itr )
+	    {
+	      ca += ( bits[*itr/8] >> (*itr%8) ) & 1;
+	    }
+	  rv[i] = chisq(ncarriers-ca,ncontrols-(ncarriers-ca),ca,ncases-ca);
+	}
+      return rv;
+    }
+
+  IntegerVector status(p->n);
+  for( unsigned i = 0 ; i < p->nperms ; ++i )
+    {
+      p->labels(i,status.begin());
+      stat_LLcollapse f( maf, status, maf_controls );
+      rv[i] = as<double>( stat_calculator(ccdata,status,f)["statistic"] );
+      checkUserInterrupt();
     }
   return rv;
 }
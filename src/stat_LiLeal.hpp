@@ -19,6 +19,7 @@ private:
   mutable bool mafc;
   Rcpp::IntegerVector hasRare,hasRare_site,status;
   unsigned sum,ind,ncontrols,N;
+  void table( unsigned & co, unsigned & cowo, unsigned & ca, unsigned & cawo ) const;
 public:
   stat_LLcollapse( const double & __maf, const Rcpp::IntegerVector & ccstatus,
 		   const bool & maf_control = true );
@@ -26,6 +27,13 @@ public:
   virtual void operator()(const int & genotype,
 			  const int & ccstatus);
   virtual Rcpp::List values();
+  //Per individual, the number of rare alleles carried (> 0 means "carrier")
+  const Rcpp::IntegerVector & carriers() const { return hasRare; }
+  /*
+    Exact permutation p-value of values()["statistic"].  Only valid when
+    the MAF is calculated from all individuals (maf_control = false).
+  */
+  double exact_p() const;
 };
 
 #endif
@@ -8,7 +8,10 @@ class stat_MadsenBrowning : public stat_base
 private:
   unsigned ncontrols,minor_count,ind;
   const Rcpp::IntegerVector * status;
-  std::vector<double> scores,scores_rec,scores_dom,scores_site,scores_rec_site,scores_dom_site;
+  std::vector<double> scores,scores_rec,scores_dom;
+  //carriers of the current site, and their genotypes
+  std::vector<unsigned> site_ind;
+  std::vector<int> site_geno;
 public:
   stat_MadsenBrowning( const unsigned & __nrows,
 		       const unsigned & __ncontrols,
@@ -0,0 +1,177 @@
+#include <stat_VT.hpp>
+#include <chisq.hpp>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+using namespace Rcpp;
+using namespace std;
+
+stat_VT::stat_VT( const double & __maf_max,
+		  const Rcpp::IntegerVector & ccstatus,
+		  const bool & maf_control ) : maf_max(__maf_max),
+					       mafc(maf_control),
+					       status(ccstatus),
+					       N(ccstatus.size()),
+					       ncontrols(count(ccstatus.begin(),ccstatus.end(),0)),
+					       ind(0),sum(0),
+					       site_ind(vector<unsigned>()),
+					       site_geno(vector<int>()),
+					       offsets(vector<size_t>(1,0)),
+					       carrier_ind(vector<unsigned>()),
+					       site_sum(vector<unsigned>()),
+					       carrier_geno(vector<int>()),
+					       cached(false),
+					       cache_thresholds(vector<double>()),
+					       cache_first(vector<unsigned>())
+{
+}
+
+void stat_VT::operator()(const int & genotype,
+			 const int & ccstatus)
+{
+  if( genotype > 0 )
+    {
+      site_ind.push_back(ind);
+      site_geno.push_back(genotype);
+    }
+  sum += genotype;
+  ++ind;
+}
+
+void stat_VT::update()
+{
+  //Sites without carriers can't change any carrier status, so aren't kept
+  if( !site_ind.empty() )
+    {
+      carrier_ind.insert(carrier_ind.end(),site_ind.begin(),site_ind.end());
+      carrier_geno.insert(carrier_geno.end(),site_geno.begin(),site_geno.end());
+      offsets.push_back(carrier_ind.size());
+      site_sum.push_back(sum);
+    }
+  site_ind.clear();
+  site_geno.clear();
+  ind = sum = 0;
+}
+
+void stat_VT::assign( const Rcpp::IntegerVector & labels,
+		      vector<double> & thresholds,
+		      vector<unsigned> & first ) const
+{
+  const unsigned nsites = site_sum.size();
+  vector< pair<double,unsigned> > mafs;
+  mafs.reserve(nsites);
+  for( unsigned s = 0 ; s < nsites ; ++s )
+    {
+      double maf;
+      if( mafc )
+	{
+	  unsigned c = 0;
+	  for( size_t k = offsets[s] ; k < offsets[s+1] ; ++k )
+	    {
+	      if( !labels[carrier_ind[k]] ) c += carrier_geno[k];
+	    }
+	  maf = double(c)/double(2*ncontrols);
+	}
+      else
+	{
+	  maf = double(site_sum[s])/double(2*N);
+	}
+      if( maf <= maf_max )
+	{
+	  mafs.push_back( make_pair(maf,s) );
+	}
+    }
+  sort(mafs.begin(),mafs.end());
+
+  const unsigned NEVER = numeric_limits<unsigned>::max();
+  thresholds.clear();
+  first.assign(N,NEVER);
+  for( vector< pair<double,unsigned> >::const_iterator itr = mafs.begin() ; itr != mafs.end() ; ++itr )
+    {
+      if( thresholds.empty() || itr->first != thresholds.back() )
+	{
+	  thresholds.push_back(itr->first);
+	}
+      //sites are visited in order of increasing MAF, so the first cutoff assigned is the smallest
+      const unsigned t = thresholds.size()-1;
+      for( size_t k = offsets[itr->second] ; k < offsets[itr->second+1] ; ++k )
+	{
+	  if( first[carrier_ind[k]] == NEVER ) first[carrier_ind[k]] = t;
+	}
+    }
+  replace(first.begin(),first.end(),NEVER,unsigned(thresholds.size()));
+}
+
+double stat_VT::scan( const Rcpp::IntegerVector & labels,
+		      vector<double> & thresholds,
+		      vector<double> & stats,
+		      unsigned & which_max )
+{
+  vector<unsigned> first;
+  if( mafc )
+    {
+      assign(labels,thresholds,first);
+    }
+  else
+    {
+      if( !cached )
+	{
+	  assign(labels,cache_thresholds,cache_first);
+	  cached = true;
+	}
+      thresholds = cache_thresholds;
+    }
+  const vector<unsigned> & fi = (mafc) ? first : cache_first;
+  const unsigned T = thresholds.size();
+
+  //number of cases and controls who first become carriers at each cutoff
+  vector<unsigned> newca(T+1,0),newco(T+1,0);
+  unsigned ncases = 0;
+  for( unsigned i = 0 ; i < N ; ++i )
+    {
+      if( labels[i] )
+	{
+	  ++newca[fi[i]];
+	  ++ncases;
+	}
+      else
+	{
+	  ++newco[fi[i]];
+	}
+    }
+  stats.resize(T);
+  unsigned ca = 0, co = 0;
+  double mx = 0.;
+  which_max = T;
+  for( unsigned t = 0 ; t < T ; ++t )
+    {
+      ca += newca[t];
+      co += newco[t];
+      stats[t] = chisq(co,(N-ncases)-co,ca,ncases-ca);
+      if( which_max == T || stats[t] > mx )
+	{
+	  mx = stats[t];
+	  which_max = t;
+	}
+    }
+  return mx;
+}
+
+Rcpp::List stat_VT::values()
+{
+  vector<double> thresholds,stats;
+  unsigned which_max;
+  double mx = scan(status,thresholds,stats,which_max);
+  return List::create( Named("thresholds") = NumericVector(thresholds.begin(),thresholds.end()),
+		       Named("statistics") = NumericVector(stats.begin(),stats.end()),
+		       Named("statistic") = mx,
+		       Named("threshold") = (which_max < thresholds.size()) ? thresholds[which_max] : NA_REAL );
+}
+
+double stat_VT::max_statistic( const Rcpp::IntegerVector & labels )
+{
+  vector<double> thresholds,stats;
+  unsigned which_max;
+  return scan(labels,thresholds,stats,which_max);
+}
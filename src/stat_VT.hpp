@@ -0,0 +1,62 @@
+#ifndef __STAT_VT_HPP__
+#define __STAT_VT_HPP__
+
+#include <stat_base.hpp>
+#include <vector>
+#include <cstddef>
+
+/*
+  Variable-threshold (VT) version of Li and Leal's collapsing method.
+
+  Rather than one MAF cutoff, every distinct MAF <= maf_max is used as a cutoff.
+  The statistic for a cutoff is the same chi-squared statistic that stat_LLcollapse
+  calculates for that cutoff.
+
+  A single pass over the data stores each site's carriers (a sparse copy of the
+  non-zero genotypes).  The sites are then sorted by MAF once, and each individual
+  is assigned the first cutoff at which it carries a rare allele.  The number of
+  carriers among cases and controls at every cutoff then follows from cumulative
+  sums.  See Price et al. (2010) Am. J. Hum. Genet. 86:832-838 for the VT idea.
+ */
+class stat_VT : public stat_base
+{
+private:
+  double maf_max;
+  bool mafc;
+  Rcpp::IntegerVector status;
+  unsigned N,ncontrols,ind,sum;
+  //current site
+  std::vector<unsigned> site_ind;
+  std::vector<int> site_geno;
+  //stored sites, as offsets into flat arrays of carriers
+  std::vector<size_t> offsets;
+  std::vector<unsigned> carrier_ind,site_sum;
+  std::vector<int> carrier_geno;
+  //When MAFs don't depend on labels, cutoffs and first-carrier indexes are cached
+  bool cached;
+  std::vector<double> cache_thresholds;
+  std::vector<unsigned> cache_first;
+  /*
+    Fills thresholds and first (the index of the first cutoff at which each
+    individual is a carrier, or thresholds.size() if never) for a labelling.
+   */
+  void assign( const Rcpp::IntegerVector & labels,
+	       std::vector<double> & thresholds,
+	       std::vector<unsigned> & first ) const;
+  //Statistic at each cutoff for a labelling.  Returns the maximum and its index.
+  double scan( const Rcpp::IntegerVector & labels,
+	       std::vector<double> & thresholds,
+	       std::vector<double> & stats,
+	       unsigned & which_max );
+public:
+  stat_VT( const double & __maf_max, const Rcpp::IntegerVector & ccstatus,
+	   const bool & maf_control = false );
+  virtual void update();
+  virtual void operator()(const int & genotype,
+			  const int & ccstatus);
+  virtual Rcpp::List values();
+  //Max over cutoffs for another labelling of the same individuals, without re-reading the data
+  double max_statistic( const Rcpp::IntegerVector & labels );
+};
+
+#endif
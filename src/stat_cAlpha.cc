@@ -63,32 +63,18 @@ void stat_cAlpha::operator()(const int & genotype,
 
 double stat_cAlpha::Z() const
 {
-  double Z = 0.;
   if( norm )
     {
-      for( map<unsigned,unsigned>::const_iterator itr = ns.begin() ; itr != ns.end() ; ++itr )
-	{
-	  double n = double(itr->first),m_of_n=double(itr->second);
-	  double inner=0.;
-	  double np01mp0 = n*p0*(1.-p0);
-	  double np0 = n*p0;
-	  for( unsigned u = 0 ; u <= n ; ++u )
-	    {
-	      inner += R::dbinom(u,n,p0,0)*pow((pow(u-np0,2.) - np01mp0),2.);
-	    }
-	  Z += m_of_n*inner;
-	}
-    }
-  else
-    {
-      Z = numeric_limits<double>::quiet_NaN();
+      return cAlpha_Z(ns,p0);
     }
-  return Z;
+  return numeric_limits<double>::quiet_NaN();
 }
 
 Rcpp::List stat_cAlpha::values()
 {
   double __Z = Z();
-  return List::create( Named("statistic") = (norm) ? T/sqrt(__Z) : T
+  return List::create( Named("statistic") = (norm) ? T/sqrt(__Z) : T,
+		       Named("T") = T,
+		       Named("variance") = __Z
 		       );
 }
@@ -2,7 +2,9 @@
 #define __STAT_CALPHA_HPP__
 
 #include <stat_base.hpp>
+#include <cAlpha_variance.hpp>
 #include <map>
+
 class stat_cAlpha : public stat_base
 {
 private:
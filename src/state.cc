@@ -0,0 +1,126 @@
+#include <Rcpp.h>
+#include <burden_state.hpp>
+#include <string>
+#include <vector>
+
+using namespace Rcpp;
+using namespace std;
+
+namespace {
+  burden_state read_state( const RawVector & x, const char * caller )
+  {
+    burden_state s;
+    string error;
+    if( !s.deserialize(x.begin(),x.size(),error) )
+      {
+	stop( string(caller) + ": " + error );
+      }
+    return s;
+  }
+
+  RawVector write_state( const burden_state & s )
+  {
+    vector<unsigned char> buffer;
+    s.serialize(buffer);
+    return RawVector(buffer.begin(),buffer.end());
+  }
+}
+
+//' Sufficient statistics for burden tests, which can be updated with new individuals
+//' @param ccdata A matrix of markers (columns) and individuals (rows).  Data are coded as the number of copies of the minor allele.
+//' @param ccstatus A vector of binary phenotype labels.  0 = control, 1 = case.
+//' @return A raw vector holding the state, which may be saved with saveRDS or writeBin.
+//' @details The state holds the allele and carrier counts of each marker, in everyone and in cases, and the markers carried by
+//' each individual.  States for different individuals typed at the same markers may be combined with burdenStateMerge,
+//' and burdenStateStats gives the statistics of the combined sample.  A large cohort may therefore be processed in
+//' shards of rows, and a new batch of individuals only requires a state for the new rows.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' genos = rec.ccdata$genos[,which(keep==1)]
+//' half = floor(nrow(genos)/2)
+//' s1 = burdenState(genos[1:half,],status[1:half])
+//' s2 = burdenState(genos[-(1:half),],status[-(1:half)])
+//' stats = burdenStateStats(burdenStateMerge(s1,s2),50,0.05)
+// [[Rcpp::export]]
+RawVector burdenState( const IntegerMatrix & ccdata,
+		       const IntegerVector & ccstatus )
+{
+  if( ccstatus.size() != ccdata.nrow() )
+    {
+      stop("burdenState: length(ccstatus) != nrow(ccdata)");
+    }
+  burden_state s(ccdata.ncol());
+  vector<int> status(ccstatus.begin(),ccstatus.end());
+  string error;
+  if( !s.add_rows(ccdata.begin(),ccdata.nrow(),status.empty() ? 0 : &status[0],error) )
+    {
+      stop("burdenState: " + error);
+    }
+  return write_state(s);
+}
+
+//' Combine the burden states of two sets of individuals
+//' @param x A state from burdenState or burdenStateMerge
+//' @param y A state for other individuals, typed at the same markers as x
+//' @return The state of the individuals of x followed by those of y
+//' @details Per-marker counts are added, and the markers carried by each individual are appended.  Neither state's genotypes are re-read.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' s1 = burdenState(rec.ccdata$genos[1:100,],status[1:100])
+//' s2 = burdenState(rec.ccdata$genos[-(1:100),],status[-(1:100)])
+//' s = burdenStateMerge(s1,s2)
+// [[Rcpp::export]]
+RawVector burdenStateMerge( const RawVector & x,
+			    const RawVector & y )
+{
+  burden_state sx = read_state(x,"burdenStateMerge"), sy = read_state(y,"burdenStateMerge");
+  string error;
+  if( !sx.merge(sy,error) )
+    {
+      stop("burdenStateMerge: " + error);
+    }
+  return write_state(sx);
+}
+
+//' Burden statistics from a burden state
+//' @param state A state from burdenState or burdenStateMerge
+//' @param esm_K The number of markers to use in the calculation of ESM_K
+//' @param LLc_maf For Li and Leal's statistic, only consider variants whose minor allele frequencies are <= maf
+//' @param LLc_maf_control  For Li and Leal's statistic, calculate MAF from controls only if TRUE, otherwise from entire sample
+//' @param normalize_calpha If TRUE, return T/sqrt(Z), otherwise return T.
+//' @param simplecount_calpha see allBurdenStats
+//' @param esm_fisher see allBurdenStats
+//' @return The same list as allBurdenStats for the individuals of the state, in the order in which they were added
+//' @details ESM and c-alpha are calculated from the per-marker counts alone.  The Madsen-Browning weights, and which markers
+//' are rare for Li and Leal's statistic, depend on allele frequencies in the whole sample, and change when individuals are added.
+//' The Madsen-Browning scores and ranks, and the Li-Leal carrier indicators, are therefore rebuilt on every call from the markers
+//' carried by each individual.  This costs time proportional to the number of non-zero genotypes, not to the size of the genotype matrix.
+//' @examples
+//' data(rec.ccdata)
+//' status = c(rep(0,rec.ccdata$ncontrols),rep(1,rec.ccdata$ncases))
+//' keep = filter_sites(rec.ccdata$genos,status,0,0.05,0.8)
+//' s = burdenState(rec.ccdata$genos[,which(keep==1)],status)
+//' stats = burdenStateStats(s,50,0.05)
+// [[Rcpp::export]]
+List burdenStateStats( const RawVector & state,
+		       const unsigned & esm_K,
+		       const double & LLc_maf,
+		       const bool & LLc_maf_control = true,
+		       const bool normalize_calpha = false,
+		       const bool simplecount_calpha = false,
+		       const bool esm_fisher = false )
+{
+  burden_state s = read_state(state,"burdenStateStats");
+  vector<double> v;
+  burden_state_stats(s,esm_K,LLc_maf,LLc_maf_control,normalize_calpha,simplecount_calpha,v,esm_fisher);
+  return List::create( Named("esm.stat") = v[0],
+		       Named("esm.K") = esm_K,
+		       Named("calpha.stat") = v[1],
+		       Named("MB.general.stat") = v[2],
+		       Named("MB.recessive.stat") = v[3],
+		       Named("MB.dominant.stat") = v[4],
+		       Named("LL.collapse.stat") = v[5] );
+}
@@ -0,0 +1,57 @@
+#include <validate.hpp>
+#include <algorithm>
+#include <string>
+
+using namespace Rcpp;
+using namespace std;
+
+namespace
+{
+  void check_labels( const int * first, const int * last, const char * caller )
+  {
+    if( find_if(first,last,[](int s){ return s != 0 && s != 1; }) != last )
+      {
+	stop(string(caller) + ": phenotype label other than 0 or 1 encountered");
+      }
+  }
+}
+
+sparse_genotypes validate_genotypes( const IntegerMatrix & ccdata, const char * caller )
+{
+  sparse_genotypes G(ccdata.begin(),ccdata.nrow(),ccdata.ncol());
+  //Zeros are not stored, so only the non-zero genotypes need checking
+  if( find_if(G.geno.begin(),G.geno.end(),[](int g){ return g < 0 || g > 2; }) != G.geno.end() )
+    {
+      stop(string(caller) + ": genotype value other than 0, 1, or 2 was encountered");
+    }
+  return G;
+}
+
+void validate_labels( const IntegerVector & ccstatus, const char * caller )
+{
+  check_labels(ccstatus.begin(),ccstatus.end(),caller);
+}
+
+void validate_labels( const IntegerMatrix & phenotypes, const char * caller )
+{
+  check_labels(phenotypes.begin(),phenotypes.end(),caller);
+}
+
+perm_plan * validate_plan( XPtr<perm_plan> plan, const char * caller )
+{
+  if( plan.get() == 0 )
+    {
+      stop( string(caller) + ": the plan no longer exists.  Use permPlanOpen to reload it from its file." );
+    }
+  return plan.get();
+}
+
+perm_plan * validate_plan( XPtr<perm_plan> plan, const IntegerVector & ccstatus, const char * caller )
+{
+  perm_plan * p = validate_plan(plan,caller);
+  if( unsigned(ccstatus.size()) != p->n || unsigned(count(ccstatus.begin(),ccstatus.end(),1)) != p->ncases )
+    {
+      stop(string(caller) + ": the plan was made for a different number of individuals or cases");
+    }
+  return p;
+}
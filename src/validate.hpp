@@ -0,0 +1,26 @@
+#ifndef __VALIDATE_HPP__
+#define __VALIDATE_HPP__
+
+#include <Rcpp.h>
+#include <sparse_genotypes.hpp>
+#include <perm_plan.hpp>
+
+/*
+  Argument checks shared by the exported functions.  Each one calls stop(),
+  with caller as the prefix of the message, when the check fails.
+ */
+
+//Sparse copy of ccdata.  Stops if a genotype other than 0, 1, or 2 is encountered.
+sparse_genotypes validate_genotypes( const Rcpp::IntegerMatrix & ccdata, const char * caller );
+
+//Stops if a phenotype label other than 0 or 1 is encountered
+void validate_labels( const Rcpp::IntegerVector & ccstatus, const char * caller );
+//The same, for a matrix with one column of labels per trait
+void validate_labels( const Rcpp::IntegerMatrix & phenotypes, const char * caller );
+
+//The plan behind a handle.  Stops if the handle was restored from a saved session, and so no longer points to a plan.
+perm_plan * validate_plan( Rcpp::XPtr<perm_plan> plan, const char * caller );
+//The same, and also stops if the plan was made for a different number of individuals or cases than ccstatus has
+perm_plan * validate_plan( Rcpp::XPtr<perm_plan> plan, const Rcpp::IntegerVector & ccstatus, const char * caller );
+
+#endif
@@ -0,0 +1,229 @@
+#include <window_scan.hpp>
+#include <cAlpha_variance.hpp>
+#include <mb_scores.hpp>
+#include <chisq.hpp>
+#include <esm_stat.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace {
+  //Madsen-Browning scores are multiples of 2^-30
+  const double MB_SCALE = 1073741824.;
+  /*
+    Largest 1/w_j, in those units, that is kept in fixed point (1/w_j < 1024).
+    A score sums at most 2 units per site, so sums cannot overflow for fewer
+    than 2^22 sites.  Proper weights are near sqrt(n*q*(1-q)), far from the limit.
+   */
+  const double MB_MAX_UNIT = 1099511627776.;
+  const unsigned NSCAN = 6;
+}
+
+vector<scan_window> make_windows( const vector<double> & positions,
+				  const double & width,
+				  const double & step )
+{
+  vector<scan_window> rv;
+  //A step that is not > 0 (including NaN) would never reach the last position
+  if( positions.empty() || !(step > 0.) ) return rv;
+  unsigned first = 0, last = 0;
+  const unsigned m = positions.size();
+  //start is computed from k, rather than accumulated, so it advances even when step is tiny next to positions[0]
+  for( double k = 0. ; positions[0] + k*step <= positions[m-1] ; k += 1. )
+    {
+      scan_window w;
+      w.start = positions[0] + k*step;
+      w.end = w.start + width;
+      while( first < m && positions[first] < w.start ) ++first;
+      if( last < first ) last = first;
+      while( last < m && positions[last] < w.end ) ++last;
+      w.first = first;
+      w.last = last;
+      if( w.last > w.first ) rv.push_back(w);
+    }
+  return rv;
+}
+
+window_scan::window_scan( const sparse_genotypes & __G,
+			  const unsigned & __esm_K,
+			  const double & __LLc_maf,
+			  const bool & __LLc_maf_control,
+			  const bool & __normalize_calpha,
+			  const bool & __simplecount_calpha,
+			  const bool & __esm_fisher ) : G(__G),
+								esm_K(__esm_K),
+								LLc_maf(__LLc_maf),
+								LLc_maf_control(__LLc_maf_control),
+								normalize_calpha(__normalize_calpha),
+								simplecount_calpha(__simplecount_calpha),
+								esm_fisher(__esm_fisher),
+								fisher(map<unsigned,fisher_exact>()),
+								log10p(vector<double>(__G.ncol)),
+								cterm(vector<double>(__G.ncol)),
+								nkey(vector<unsigned>(__G.ncol)),
+								mbunit(vector<int64_t>(__G.ncol)),
+								rare(vector<char>(__G.ncol)),
+								esm_scores(multiset<double>()),
+								T(0.),
+								ns(map<unsigned,unsigned>()),
+								nsites_carried(vector<unsigned>(__G.nrow,0)),
+								active(vector<unsigned>()),
+								active_pos(vector<unsigned>(__G.nrow,0)),
+								rare_count(vector<unsigned>(__G.nrow,0)),
+								sg(vector<int64_t>(__G.nrow,0)),
+								sr(vector<int64_t>(__G.nrow,0)),
+								sd(vector<int64_t>(__G.nrow,0)),
+								co(0),ca(0),
+								mb_invalid(0)
+{
+}
+
+void window_scan::add( const unsigned & j, const int * labels )
+{
+  esm_scores.insert(log10p[j]);
+  T += cterm[j];
+  if( normalize_calpha ) ++ns[nkey[j]];
+  if( !mbunit[j] ) ++mb_invalid;
+  for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+    {
+      const unsigned i = G.rowind[k];
+      const int g = G.geno[k];
+      if( nsites_carried[i]++ == 0 )
+	{
+	  active_pos[i] = active.size();
+	  active.push_back(i);
+	}
+      sg[i] += int64_t(g)*mbunit[j];
+      sd[i] += mbunit[j];
+      if( g == 2 ) sr[i] += mbunit[j];
+      if( rare[j] && rare_count[i]++ == 0 )
+	{
+	  if( labels[i] ) ++ca;
+	  else ++co;
+	}
+    }
+}
+
+void window_scan::remove( const unsigned & j, const int * labels )
+{
+  esm_scores.erase( esm_scores.find(log10p[j]) );
+  T -= cterm[j];
+  if( !mbunit[j] ) --mb_invalid;
+  if( normalize_calpha )
+    {
+      map<unsigned,unsigned>::iterator itr = ns.find(nkey[j]);
+      if( --(itr->second) == 0 ) ns.erase(itr);
+    }
+  for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+    {
+      const unsigned i = G.rowind[k];
+      const int g = G.geno[k];
+      sg[i] -= int64_t(g)*mbunit[j];
+      sd[i] -= mbunit[j];
+      if( g == 2 ) sr[i] -= mbunit[j];
+      if( --nsites_carried[i] == 0 )
+	{
+	  //swap the last active individual into i's place
+	  const unsigned last = active.back();
+	  active[active_pos[i]] = last;
+	  active_pos[last] = active_pos[i];
+	  active.pop_back();
+	}
+      if( rare[j] && --rare_count[i] == 0 )
+	{
+	  if( labels[i] ) --ca;
+	  else --co;
+	}
+    }
+}
+
+void window_scan::operator()( const int * labels,
+			      const vector<scan_window> & windows,
+			      vector< vector<double> > * per_window,
+			      vector<double> & maxima )
+{
+  const unsigned n = G.nrow, m = G.ncol;
+  unsigned ncases = 0;
+  for( unsigned i = 0 ; i < n ; ++i ) ncases += (labels[i] != 0);
+  const unsigned ncontrols = n - ncases;
+  const double p0 = double(count(labels,labels+n,1))/double(n);
+  fisher_exact * exact = (esm_fisher) ? &fisher.insert( make_pair(ncases,fisher_exact(2*n,2*ncases)) ).first->second : 0;
+
+  //Per-site values, as stat_multitrait calculates them
+  for( unsigned j = 0 ; j < m ; ++j )
+    {
+      unsigned dosage = 0, case_dosage = 0, ncarriers = 0, case_carriers = 0;
+      for( size_t k = G.colptr[j] ; k < G.colptr[j+1] ; ++k )
+	{
+	  const unsigned g = G.geno[k];
+	  dosage += g;
+	  ++ncarriers;
+	  if( labels[G.rowind[k]] )
+	    {
+	      case_dosage += g;
+	      ++case_carriers;
+	    }
+	}
+      const unsigned control_minor = dosage - case_dosage;
+      log10p[j] = (exact) ? exact->log10p( dosage, case_dosage )
+	: chisq_log10p( control_minor, 2*ncontrols - control_minor, case_dosage, 2*ncases - case_dosage );
+      const unsigned n_i = (simplecount_calpha) ? ncarriers : dosage,
+	y_i = (simplecount_calpha) ? case_carriers : case_dosage;
+      nkey[j] = n_i;
+      cterm[j] = ( pow( double(y_i)-double(n_i)*p0, 2.) - double(n_i)*p0*(1.-p0) );
+      //number of cases in place of the number of controls, as allBurdenStats always has
+      const double unit = MB_SCALE/mb_weight(control_minor,ncases,n);
+      //A weight that is 0, NaN, or infinite (as when there are more control minor alleles than 2*ncases+1) has no fixed-point value; 0 marks the site
+      mbunit[j] = ( unit >= 1. && unit < MB_MAX_UNIT ) ? int64_t( floor( unit + 0.5 ) ) : 0;
+      rare[j] = (LLc_maf_control) ? ( double(control_minor)/double(2*ncontrols) <= LLc_maf ) : ( double(dosage)/double(2*n) <= LLc_maf );
+    }
+
+  if( per_window )
+    {
+      per_window->assign(NSCAN,vector<double>());
+      for( unsigned s = 0 ; s < NSCAN ; ++s ) (*per_window)[s].reserve(windows.size());
+    }
+  maxima.assign(NSCAN,numeric_limits<double>::quiet_NaN());
+
+  unsigned first = 0, last = 0;
+  mb_rank_engine ranker;
+  vector<double> v(NSCAN);
+  for( vector<scan_window>::const_iterator w = windows.begin() ; w != windows.end() ; ++w )
+    {
+      //leading edge, then trailing edge
+      for( ; last < w->last ; ++last ) add(last,labels);
+      for( ; first < w->first ; ++first ) remove(first,labels);
+
+      const unsigned nsites = w->last - w->first, k = min(esm_K,nsites);
+      multiset<double>::const_reverse_iterator top = esm_scores.rbegin(), topk = top;
+      advance(topk,k);
+      v[0] = esm_top(top,topk,nsites);
+      v[1] = (normalize_calpha) ? T/sqrt(cAlpha_Z(ns,p0)) : T;
+      if( mb_invalid )
+	{
+	  //Scores would not be finite
+	  v[2] = v[3] = v[4] = numeric_limits<double>::quiet_NaN();
+	}
+      else
+	{
+	  ranker.clear();
+	  for( vector<unsigned>::const_iterator i = active.begin() ; i != active.end() ; ++i )
+	    {
+	      ranker.push_back( double(sg[*i]), double(sr[*i]), double(sd[*i]), labels[*i] == 1 );
+	    }
+	  ranker(n,ncases,v[2],v[3],v[4]);
+	}
+      v[5] = chisq(co,ncontrols-co,ca,ncases-ca);
+
+      for( unsigned s = 0 ; s < NSCAN ; ++s )
+	{
+	  if( per_window ) (*per_window)[s].push_back(v[s]);
+	  if( v[s] == v[s] && ( maxima[s] != maxima[s] || v[s] > maxima[s] ) ) maxima[s] = v[s];
+	}
+    }
+  //empty the running state for the next labelling
+  for( ; first < last ; ++first ) remove(first,labels);
+  T = 0.;
+}
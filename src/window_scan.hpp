@@ -0,0 +1,89 @@
+#ifndef __WINDOW_SCAN_HPP__
+#define __WINDOW_SCAN_HPP__
+
+#include <sparse_genotypes.hpp>
+#include <fisher_exact.hpp>
+#include <map>
+#include <set>
+#include <vector>
+#include <stdint.h>
+
+/*
+  Burden statistics in sliding windows along a chromosome.
+
+  Moving from one window to the next adds the sites entering at the leading
+  edge and removes those leaving at the trailing edge.  Every statistic has
+  running state that a site can be added to or removed from in O(carriers):
+
+  ESM: the sites' -log10 p-values (chi-squared, or Fisher's exact test if
+       esm_fisher), in a multiset, whose largest K are summed
+  c-alpha: the sum of per-site terms, and counts of sites by number of observations
+  Madsen-Browning: each individual's scores, plus the set of current carriers
+  Li-Leal: each individual's number of rare sites, and carrier counts in cases and controls
+
+  Madsen-Browning scores are kept in fixed point (units of 2^-30), so that
+  removing a site restores a score exactly and individuals carrying the same
+  sites are tied, as they are in MBstat.  A window containing a site whose
+  weight is 0, NaN, or infinite gets NaN for the Madsen-Browning statistics.  The c-alpha sum is a running sum of
+  doubles, and may differ from allBurdenStats in the last bits.  Otherwise,
+  each window gets the values that allBurdenStats gives for its sites.
+ */
+
+struct scan_window
+{
+  double start,end;
+  //sites [first,last)
+  unsigned first,last;
+};
+
+//Windows [start,start+width) for start = positions[0], positions[0]+step, ..., keeping those with at least one site.
+//There are no windows unless step > 0.
+std::vector<scan_window> make_windows( const std::vector<double> & positions,
+				       const double & width,
+				       const double & step );
+
+class window_scan
+{
+private:
+  const sparse_genotypes & G;
+  unsigned esm_K;
+  double LLc_maf;
+  bool LLc_maf_control,normalize_calpha,simplecount_calpha,esm_fisher;
+  //Fisher's exact test of a site, for each number of cases seen
+  std::map<unsigned,fisher_exact> fisher;
+  //per-site values for the current labels
+  std::vector<double> log10p,cterm;
+  std::vector<unsigned> nkey;
+  std::vector<int64_t> mbunit;
+  std::vector<char> rare;
+  //running state
+  std::multiset<double> esm_scores;
+  double T;
+  std::map<unsigned,unsigned> ns;
+  std::vector<unsigned> nsites_carried,active,active_pos,rare_count;
+  std::vector<int64_t> sg,sr,sd;
+  unsigned co,ca;
+  //sites in the window whose Madsen-Browning weight has no fixed-point value
+  unsigned mb_invalid;
+  void add( const unsigned & j, const int * labels );
+  void remove( const unsigned & j, const int * labels );
+public:
+  window_scan( const sparse_genotypes & __G,
+	       const unsigned & __esm_K,
+	       const double & __LLc_maf,
+	       const bool & __LLc_maf_control,
+	       const bool & __normalize_calpha,
+	       const bool & __simplecount_calpha,
+	       const bool & __esm_fisher = false );
+  /*
+    Scans all windows with one labelling (0 = control, 1 = case).  If per_window is
+    not 0, it receives one vector per statistic (allBurdenStats order, without esm.K),
+    with one value per window.  maxima receives the maximum of each statistic over windows.
+   */
+  void operator()( const int * labels,
+		   const std::vector<scan_window> & windows,
+		   std::vector< std::vector<double> > * per_window,
+		   std::vector<double> & maxima );
+};
+
+#endif